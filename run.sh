@@ -23,6 +23,16 @@ WARNINGS="-Weverything \
     -Wno-unused-argument \
     "
 
+# consistency checks: `DEBUG=1 ./run.sh`
+if [ "$DEBUG" = "1" ]; then
+    CPPFLAGS="$CPPFLAGS -DOSCA_DEBUG"
+fi
+
+# headless benchmark: `BENCHMARK=1 ./run.sh`
+if [ "$BENCHMARK" = "1" ]; then
+    CPPFLAGS="$CPPFLAGS -DOSCA_BENCHMARK"
+fi
+
 clang++ $FLAGS $CPPFLAGS $WARNINGS \
     -I /usr/include/efi/ \
     -c src/uefi.cpp -o uefi.o
@@ -34,6 +44,11 @@ clang++ $FLAGS $CPPFLAGS $WARNINGS \
     -I /usr/include/efi/ \
     -c src/kernel.cpp -o kernel.o
 
+# minimal tier interrupt handlers must not touch simd state
+clang++ $FLAGS $CPPFLAGS $WARNINGS -mgeneral-regs-only \
+    -I /usr/include/efi/ \
+    -c src/kernel_isr.cpp -o kernel_isr.o
+
 clang++ $FLAGS $CPPFLAGS $WARNINGS \
     -I /usr/include/efi/ \
     -c src/osca.cpp -o osca.o
@@ -44,10 +59,47 @@ clang++ -target x86_64-unknown-windows-msvc \
     -Wl,-entry:efi_main \
     -Wl,-subsystem:efi_application \
     -o esp/EFI/BOOT/BOOTX64.EFI \
-    uefi.o kernel_asm.o kernel.o osca.o
+    uefi.o kernel_asm.o kernel.o kernel_isr.o osca.o
+
+# two numa nodes of two cores and 8GB each with remote distance 20
+# note: enabled by `NUMA=1 ./run.sh`
+SMP="-smp 4,sockets=1,cores=2,threads=2"
+if [ "$NUMA" = "1" ]; then
+    SMP="-smp 4,sockets=2,cores=2,threads=1 \
+        -object memory-backend-ram,id=mem0,size=8G \
+        -object memory-backend-ram,id=mem1,size=8G \
+        -numa node,nodeid=0,cpus=0-1,memdev=mem0 \
+        -numa node,nodeid=1,cpus=2-3,memdev=mem1 \
+        -numa dist,src=0,dst=1,val=20"
+fi
+
+if [ "$BENCHMARK" = "1" ]; then
+    # kvm when available, otherwise plain tcg
+    ACCEL="-accel tcg -cpu max"
+    if [ -w /dev/kvm ]; then
+        ACCEL="-enable-kvm -cpu host"
+    fi
+
+    # results are json lines on serial; kernel exits through isa-debug-exit
+    set +e
+    qemu-system-x86_64 $ACCEL -m 16G -vga std -display none -serial stdio \
+        $SMP \
+        -drive if=pflash,format=raw,readonly=on,file=/usr/share/OVMF/x64/OVMF_CODE.4m.fd \
+        -drive format=raw,file=fat:rw:esp \
+        -device isa-debug-exit,iobase=0xf4,iosize=0x04 \
+        -no-reboot
+    STATUS=$?
+    set -e
+
+    # isa-debug-exit exit status is (code << 1) | 1 where code 0 is success
+    if [ $STATUS -ne 1 ]; then
+        exit $STATUS
+    fi
+    exit 0
+fi
 
 qemu-system-x86_64 -enable-kvm -cpu host -m 16G -vga std -serial stdio \
-    -smp 4,sockets=1,cores=2,threads=2 \
+    $SMP \
     -drive if=pflash,format=raw,readonly=on,file=/usr/share/OVMF/x64/OVMF_CODE.4m.fd \
     -drive format=raw,file=fat:rw:esp \
     -d cpu_reset,int,guest_errors -no-reboot -D qemu_crash.log
@@ -41,6 +41,18 @@ auto inline sub(T* const target, T const delta, i32 const mem_order) -> T {
     return __atomic_fetch_sub(target, delta, mem_order);
 }
 
+// atomically ors bits and returns the previous value
+template <typename T>
+auto inline bit_or(T* const target, T const bits, i32 const mem_order) -> T {
+    return __atomic_fetch_or(target, bits, mem_order);
+}
+
+// atomically ands bits and returns the previous value
+template <typename T>
+auto inline bit_and(T* const target, T const bits, i32 const mem_order) -> T {
+    return __atomic_fetch_and(target, bits, mem_order);
+}
+
 // atomically replaces value and returns the previous value
 template <typename T>
 auto inline exchange(T* const target, T const val, i32 const mem_order) -> T {
@@ -59,4 +71,32 @@ auto inline store(T* const target, T const val, i32 const mem_order) -> void {
     __atomic_store_n(target, val, mem_order);
 }
 
+//
+// test-and-test-and-set spin lock
+//
+// constraints:
+//  * critical sections are short
+//  * must not be taken by an interrupt handler that may interrupt a holder on
+//    the same core
+//
+class Spinlock final {
+    u32 locked_;
+
+  public:
+    auto lock() -> void {
+        // (1) paired with release (2)
+        while (exchange(&locked_, 1u, ACQUIRE)) {
+            // spin on plain load to keep the cache line shared while held
+            while (load(&locked_, RELAXED)) {
+                __builtin_ia32_pause();
+            }
+        }
+    }
+
+    auto unlock() -> void {
+        // (2) paired with acquire (1)
+        store(&locked_, 0u, RELEASE);
+    }
+};
+
 } // namespace atomic
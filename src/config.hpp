@@ -5,7 +5,82 @@ namespace config {
 // 2MB core stack
 auto constexpr CORE_STACK_SIZE_PAGES = 2 * 1024 * 1024 / 4096u;
 
+// start application processors with one init-sipi-sipi round for all cores
+// note: false starts them one at a time; compare `init_cores` in the boot
+//       timeline
+auto constexpr PARALLEL_CORE_START = true;
+
 // timer ticks 2 times a second
 auto constexpr TIMER_FREQUENCY_HZ = 2u;
 
+// also calibrate against the hpet (10ms) when tsc and apic frequencies are
+// enumerated by cpuid and print both
+auto constexpr VALIDATE_CPUID_CLOCK = false;
+
+// enable avx-512 state (opmask, zmm) in xcr0 when the cpu supports it
+// note: false keeps interrupt entry saves smaller on avx-512 cpus
+auto constexpr USE_AVX512 = true;
+
+// identity map ram with 1GB pages where aligned when the cpu supports them
+// note: false maps with 2MB pages at best; compare the tlb benchmark
+auto constexpr USE_1G_PAGES = true;
+
+// free memory idle cores keep zeroed ahead of time for `allocate_pages`
+auto constexpr ZERO_POOL_BYTES = 256 * 1024 * 1024ull;
+
+// per-core temporary memory for jobs reset every frame
+auto constexpr FRAME_ARENA_BYTES = 4 * 1024 * 1024ull;
+
+// back buffers of the frame loop; with 2 or more frame n + 1 renders while
+// frame n is presented
+auto constexpr FRAME_BUFFERS = 2u;
+
+// extra consistency checks that panic on failure, e.g. simd fractal kernels
+// against the scalar reference per pixel
+// note: enabled by `DEBUG=1 ./run.sh`
+#ifdef OSCA_DEBUG
+auto constexpr DEBUG = true;
+#else
+auto constexpr DEBUG = false;
+#endif
+
+// headless benchmark: skips keyboard wait, prints results as json lines on
+// serial and exits qemu
+// note: enabled by `BENCHMARK=1 ./run.sh`
+#ifdef OSCA_BENCHMARK
+auto constexpr BENCHMARK = true;
+#else
+auto constexpr BENCHMARK = false;
+#endif
+
+// jobs added in queue throughput benchmark
+auto constexpr BENCHMARK_QUEUE_JOBS = 100'000u;
+
+// frames rendered per job count in fractal benchmark
+auto constexpr BENCHMARK_FRACTAL_FRAMES = 4u;
+
+// frames zooming in one step each in fractal zoom benchmark
+auto constexpr BENCHMARK_FRACTAL_ZOOM_FRAMES = 64u;
+
+// zoom step in fractal deep zoom benchmark; f32 runs out of precision past
+// about 200
+auto constexpr BENCHMARK_FRACTAL_DEEP_FRAME = 300u;
+
+// buffer size and repetitions in memcpy benchmark
+auto constexpr BENCHMARK_MEMCPY_BYTES = 32 * 1024 * 1024u;
+auto constexpr BENCHMARK_MEMCPY_REPEATS = 4u;
+
+// rounds of 256 single page allocations and frees per job in allocation
+// benchmark
+auto constexpr BENCHMARK_ALLOC_ROUNDS = 64u;
+
+// buffer size and random page reads in tlb benchmark
+// note: halved down to `BENCHMARK_TLB_MIN_BYTES` while no free block fits
+auto constexpr BENCHMARK_TLB_BYTES = 1024 * 1024 * 1024ull;
+auto constexpr BENCHMARK_TLB_MIN_BYTES = 64 * 1024 * 1024ull;
+auto constexpr BENCHMARK_TLB_READS = 1'000'000u;
+
+// round trips per core in ipi latency benchmark
+auto constexpr BENCHMARK_IPI_ROUND_TRIPS = 1'000u;
+
 } // namespace config
@@ -0,0 +1,378 @@
+#pragma once
+
+#include "atomic.hpp"
+#include "font.hpp"
+#include "kernel.hpp"
+#include "types.hpp"
+
+namespace console {
+
+auto constexpr COLOR = 0x00'cc'cc'ccu;
+auto constexpr BACKGROUND = 0x00'00'00'22u;
+
+//
+// multi-producer, single-consumer lock-free ring of text lines
+//
+// thread safety:
+//  * push(): any core, also from interrupt handlers
+//  * pop(): single consumer thread only
+//
+// constraints:
+//  * lines longer than `LINE_SIZE - 1` characters are truncated
+//  * a full ring drops the line and counts it so a producer never waits
+//  * a producer interrupted between claiming and publishing its slot holds
+//    back the lines after it until it continues
+//
+template <u32 Size = 256> class LogRing final {
+    static_assert((Size & (Size - 1)) == 0 && Size > 1,
+                  "Size must be a power of 2 for efficient modulo operations");
+
+  public:
+    static auto constexpr LINE_SIZE =
+        2 * kernel::core::CACHE_LINE_SIZE - sizeof(u32);
+
+  private:
+    struct alignas(kernel::core::CACHE_LINE_SIZE) Entry {
+        char text[LINE_SIZE];
+        u32 sequence;
+    };
+
+    static_assert(sizeof(Entry) == 2 * kernel::core::CACHE_LINE_SIZE);
+
+    // producers write the slot they claimed, consumer reads it
+    Entry entries_[Size];
+
+    // producers atomically read and write
+    alignas(kernel::core::CACHE_LINE_SIZE) u32 head_;
+
+    // producers atomically add
+    u32 dropped_;
+
+    // consumer reads and writes
+    alignas(kernel::core::CACHE_LINE_SIZE) u32 tail_;
+
+  public:
+    auto init() -> void {
+        head_ = 0;
+        dropped_ = 0;
+        tail_ = 0;
+        for (auto i = 0u; i < Size; ++i) {
+            entries_[i].sequence = i;
+        }
+    }
+
+    // called from multiple producers
+    // copies `text` into the ring
+    // returns:
+    //   true if the line was placed in the ring
+    //   false if the ring was full
+    auto push(char const* const text) -> bool {
+        // optimistic read; slot availability visible at (1) and claimed at (5)
+        auto h = atomic::load(&head_, atomic::RELAXED);
+
+        while (true) {
+            auto& entry = entries_[h % Size];
+
+            // (1) paired with release (2)
+            auto const seq = atomic::load(&entry.sequence, atomic::ACQUIRE);
+
+            // signed difference correctly handles u32 wrap-around
+            auto const diff = i32(seq - h);
+
+            if (diff > 0) {
+                // competing producer took slot
+                h = atomic::load(&head_, atomic::RELAXED);
+                continue;
+            }
+
+            if (diff < 0) {
+                // consumer has not freed the slot -> ring is full
+                atomic::add(&dropped_, 1u, atomic::RELAXED);
+                return false;
+            }
+
+            // (5) atomically claim slot from competing producers
+            // note: success is relaxed because the text is published later
+            //       via `sequence`
+            if (atomic::compare_exchange(&head_, &h, h + 1, true,
+                                         atomic::RELAXED, atomic::RELAXED)) {
+                auto n = 0u;
+                while (n < LINE_SIZE - 1 && text[n]) {
+                    entry.text[n] = text[n];
+                    ++n;
+                }
+                entry.text[n] = '\0';
+
+                // (3) paired with acquire (4)
+                atomic::store(&entry.sequence, h + 1, atomic::RELEASE);
+                return true;
+            }
+
+            // competing producer took slot
+            // note: `h` is now what `head_` was at compare exchange
+        }
+    }
+
+    // called from the consumer
+    // copies the next line to `out` of `LINE_SIZE` characters
+    // returns false if there is no published line
+    auto pop(char* const out) -> bool {
+        auto& entry = entries_[tail_ % Size];
+
+        // (4) paired with release (3)
+        if (atomic::load(&entry.sequence, atomic::ACQUIRE) != tail_ + 1) {
+            return false;
+        }
+
+        for (auto i = 0u; i < LINE_SIZE; ++i) {
+            out[i] = entry.text[i];
+            if (!out[i]) {
+                break;
+            }
+        }
+
+        // hand the slot back to producers for the next lap
+        // (2) paired with acquire (1)
+        atomic::store(&entry.sequence, tail_ + Size, atomic::RELEASE);
+        ++tail_;
+        return true;
+    }
+
+    // lines dropped because the ring was full
+    auto dropped() const -> u32 {
+        return atomic::load(&dropped_, atomic::RELAXED);
+    }
+};
+
+// log of all cores shown by the console
+// note: zero initialized in data section; `init` before use
+LogRing<> inline log;
+
+// formats one line of `log`, e.g. `Line{}.p("fps: ").p(fps).end()`
+class Line {
+    char text_[LogRing<>::LINE_SIZE];
+    u32 length_ = 0;
+
+    auto put(char const c) -> void {
+        if (length_ < sizeof(text_) - 1) {
+            text_[length_] = c;
+            ++length_;
+        }
+    }
+
+  public:
+    auto p(char const* str) -> Line& {
+        while (*str) {
+            put(*str);
+            ++str;
+        }
+        return *this;
+    }
+
+    auto p(u64 val) -> Line& {
+        // u64 max is 20 digits
+        char digits[20];
+        auto i = 0u;
+        do {
+            digits[i] = char('0' + val % 10);
+            val /= 10;
+            ++i;
+        } while (val > 0);
+
+        while (i > 0) {
+            --i;
+            put(digits[i]);
+        }
+        return *this;
+    }
+
+    // `digits` lowest hex digits of `val`
+    auto p_hex(u64 const val, u32 const digits = 16) -> Line& {
+        char constexpr static hex_chars[]{"0123456789ABCDEF"};
+        for (auto i = digits; i > 0; --i) {
+            put(hex_chars[(val >> ((i - 1) * 4)) & 0xf]);
+        }
+        return *this;
+    }
+
+    // pushes the line to `log`
+    auto end() -> void {
+        text_[length_] = '\0';
+        log.push(text_);
+    }
+};
+
+//
+// character cell grid drawn to a rectangle of a frame buffer
+//
+// `write` only changes cells and marks the changed ones dirty; `draw` redraws
+// the dirty cells and nothing else
+//
+// scrolling moves the cells and their dirty flags up a row; the pixels follow
+// on the next `draw` with one block copy for all rows scrolled since, and
+// the rows that scrolled in are dirty
+//
+class Console {
+    u8* cells_ = nullptr;
+    // one per cell; nonzero if the cell's pixels are out of date
+    u8* dirty_ = nullptr;
+    u32 x_ = 0;
+    u32 y_ = 0;
+    u32 columns_ = 0;
+    u32 rows_ = 0;
+    u32 scale_ = 1;
+    u32 column_ = 0;
+    u32 row_ = 0;
+    // rows scrolled since the last `draw`
+    u32 scrolled_ = 0;
+
+    auto cell_size() const -> u32 { return font::SIZE * scale_; }
+
+    auto scroll() -> void {
+        auto const cells = columns_ * (rows_ - 1);
+        memmove(cells_, cells_ + columns_, cells);
+        memmove(dirty_, dirty_ + columns_, cells);
+        for (auto i = cells; i < cells + columns_; ++i) {
+            cells_[i] = ' ';
+            dirty_[i] = 1;
+        }
+        if (scrolled_ < rows_) {
+            ++scrolled_;
+        }
+    }
+
+    // the cursor row is `rows_` after the last row; it scrolls only once a
+    // character is written there so the last row is not always empty
+    auto new_line() -> void {
+        column_ = 0;
+        if (row_ == rows_) {
+            scroll();
+        } else {
+            ++row_;
+        }
+    }
+
+    auto put(char const c) -> void {
+        if (c == '\n') {
+            new_line();
+            return;
+        }
+        if (column_ == columns_) {
+            // wrap
+            new_line();
+        }
+        if (row_ == rows_) {
+            scroll();
+            --row_;
+        }
+        auto const i = row_ * columns_ + column_;
+        if (cells_[i] != u8(c)) {
+            cells_[i] = u8(c);
+            dirty_[i] = 1;
+        }
+        ++column_;
+    }
+
+  public:
+    // grid of the cells of `scale` fitting the `width` by `height` pixels at
+    // (x, y); cells are blank and dirty
+    auto init(u32 const x, u32 const y, u32 const width, u32 const height,
+              u32 const scale) -> void {
+        if (cells_) {
+            kernel::free_pages(cells_, (columns_ * rows_ * 2 + 4095) / 4096);
+        }
+        x_ = x;
+        y_ = y;
+        scale_ = scale;
+        columns_ = width / cell_size();
+        rows_ = height / cell_size();
+        auto const cells = columns_ * rows_;
+        cells_ = ptr<u8>(kernel::allocate_pages_uninit((cells * 2 + 4095) /
+                                                       4096));
+        dirty_ = cells_ + cells;
+        memset(cells_, ' ', cells);
+        column_ = 0;
+        row_ = 0;
+        invalidate();
+    }
+
+    // marks every cell dirty, e.g. when the pixels were drawn over
+    auto invalidate() -> void {
+        memset(dirty_, 1, columns_ * rows_);
+        scrolled_ = 0;
+    }
+
+    // appends `text` and a new line
+    auto write(char const* text) -> void {
+        while (*text) {
+            put(*text);
+            ++text;
+        }
+        put('\n');
+    }
+
+    // writes every published line of `ring`
+    // returns lines written
+    template <u32 Size> auto drain(LogRing<Size>& ring) -> u32 {
+        char text[LogRing<Size>::LINE_SIZE];
+        auto lines = 0u;
+        while (ring.pop(text)) {
+            write(text);
+            ++lines;
+        }
+        return lines;
+    }
+
+    // brings the console's rectangle of `fb` up to date and calls
+    // `mark(x0, y0, x1, y1)` for each changed span of pixels (exclusive)
+    // returns cells drawn
+    // note: `fb` must hold the console as of the previous `draw`, otherwise
+    //       `invalidate` first
+    template <typename F>
+    auto draw(kernel::FrameBuffer const& fb, F mark) -> u32 {
+        auto const size = cell_size();
+        auto const width = columns_ * size;
+        auto* const origin = fb.pixels + u64(y_) * fb.stride + x_;
+
+        if (scrolled_ == rows_) {
+            // everything scrolled out
+            invalidate();
+        } else if (scrolled_ > 0) {
+            // one block copy of the rows still on screen
+            auto const shift = u64(scrolled_) * size * fb.stride;
+            auto const lines = (rows_ - scrolled_) * size;
+            auto const bytes =
+                ((lines - 1) * u64(fb.stride) + width) * sizeof(u32);
+            memmove(origin, origin + shift, bytes);
+            mark(x_, y_, x_ + width, y_ + lines);
+            scrolled_ = 0;
+        }
+
+        auto drawn = 0u;
+        for (auto r = 0u; r < rows_; ++r) {
+            auto first = columns_;
+            auto last = 0u;
+            for (auto c = 0u; c < columns_; ++c) {
+                auto const i = r * columns_ + c;
+                if (!dirty_[i]) {
+                    continue;
+                }
+                dirty_[i] = 0;
+                font::glyph(kernel::fpu.avx2,
+                            origin + u64(r * size) * fb.stride + c * size,
+                            fb.stride, char(cells_[i]), scale_, COLOR,
+                            BACKGROUND, true);
+                first = c < first ? c : first;
+                last = c;
+                ++drawn;
+            }
+            if (first <= last) {
+                auto const y = y_ + r * size;
+                mark(x_ + first * size, y, x_ + (last + 1) * size, y + size);
+            }
+        }
+        return drawn;
+    }
+};
+
+} // namespace console
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "ascii_font_8x8.hpp"
+#include "types.hpp"
+
+// glyphs of `ASCII_FONT` drawn a pixel row at a time
+//
+// the atlas holds every glyph row pre-expanded per scale into a 32-bit mask
+// where bit x is pixel x of the scaled row; the avx2 blitter turns 8 mask
+// bits into 8 lanes and writes them with one store
+namespace font {
+
+// pixels per glyph row and column at scale 1
+auto constexpr SIZE = 8u;
+
+// largest scale in the atlas; a row of 8 * `MAX_SCALE` pixels fits a mask
+auto constexpr MAX_SCALE = 4u;
+
+struct Atlas {
+    // [scale - 1][character][glyph row]
+    u32 rows[MAX_SCALE][128][SIZE];
+};
+
+auto consteval build_atlas() -> Atlas {
+    auto atlas = Atlas{};
+    for (auto scale = 1u; scale <= MAX_SCALE; ++scale) {
+        for (auto c = 0u; c < 128; ++c) {
+            for (auto y = 0u; y < SIZE; ++y) {
+                auto const bits = ASCII_FONT[c][y];
+                auto mask = 0u;
+                for (auto x = 0u; x < SIZE; ++x) {
+                    // leftmost pixel is the high bit of the font row
+                    if (bits & (0x80u >> x)) {
+                        mask |= ((1u << scale) - 1) << (x * scale);
+                    }
+                }
+                atlas.rows[scale - 1][c][y] = mask;
+            }
+        }
+    }
+    return atlas;
+}
+
+Atlas inline constexpr ATLAS = build_atlas();
+
+// non-printable characters are drawn as '?'
+auto inline printable(char const c) -> u8 {
+    return c < 32 || c > 126 ? u8('?') : u8(c);
+}
+
+// reference blitter: one pixel at a time from the atlas
+// note: `dst` is the glyph's top left pixel; background pixels are written
+//       only if `opaque`
+auto inline glyph_scalar(u32* const dst, u32 const stride, char const c,
+                         u32 const scale, u32 const color,
+                         u32 const background, bool const opaque) -> void {
+    auto const& rows = ATLAS.rows[scale - 1][printable(c)];
+    auto const width = SIZE * scale;
+    for (auto y = 0u; y < SIZE; ++y) {
+        auto const mask = rows[y];
+        for (auto r = 0u; r < scale; ++r) {
+            auto* const row = dst + u64(y * scale + r) * stride;
+            for (auto x = 0u; x < width; ++x) {
+                if (mask & (1u << x)) {
+                    row[x] = color;
+                } else if (opaque) {
+                    row[x] = background;
+                }
+            }
+        }
+    }
+}
+
+// scales past the atlas straight from `ASCII_FONT`
+auto inline glyph_large(u32* const dst, u32 const stride, char const c,
+                        u32 const scale, u32 const color,
+                        u32 const background, bool const opaque) -> void {
+    auto const* const bits = ASCII_FONT[printable(c)];
+    auto const width = SIZE * scale;
+    for (auto y = 0u; y < width; ++y) {
+        auto const row_bits = bits[y / scale];
+        auto* const row = dst + u64(y) * stride;
+        for (auto x = 0u; x < width; ++x) {
+            if (row_bits & (0x80u >> (x / scale))) {
+                row[x] = color;
+            } else if (opaque) {
+                row[x] = background;
+            }
+        }
+    }
+}
+
+namespace detail {
+
+using i32x8 = i32 __attribute__((vector_size(32)));
+// for stores to pixels that are not 32 byte aligned
+using i32x8_unaligned = i32 __attribute__((vector_size(32), aligned(4)));
+
+} // namespace detail
+
+// 8 pixels per store; each mask row is computed once and stored to the
+// `scale` pixel rows it covers
+// note: transparent glyphs use masked stores (vpmaskmovd) so background
+//       pixels are not touched
+[[gnu::target("avx2")]] auto inline glyph_avx2(u32* const dst,
+                                               u32 const stride, char const c,
+                                               u32 const scale,
+                                               u32 const color,
+                                               u32 const background,
+                                               bool const opaque) -> void {
+    using detail::i32x8;
+    using detail::i32x8_unaligned;
+
+    auto const lane_bits = i32x8{1, 2, 4, 8, 16, 32, 64, 128};
+    auto const fg = i32x8{} + i32(color);
+    auto const bg = i32x8{} + i32(background);
+    auto const& rows = ATLAS.rows[scale - 1][printable(c)];
+
+    for (auto y = 0u; y < SIZE; ++y) {
+        auto const mask = rows[y];
+        for (auto k = 0u; k < scale; ++k) {
+            // lanes of pixels 8 k to 8 k + 7 that are set are -1
+            auto const bits = i32x8{} + i32((mask >> (8 * k)) & 0xffu);
+            auto const on = (bits & lane_bits) != 0;
+            auto const pixels = (on & fg) | (~on & bg);
+            for (auto r = 0u; r < scale; ++r) {
+                auto* const out = dst + u64(y * scale + r) * stride + 8 * k;
+                if (opaque) {
+                    *ptr<i32x8_unaligned>(out) = pixels;
+                } else {
+                    __builtin_ia32_maskstored256(ptr<i32x8>(out), on, fg);
+                }
+            }
+        }
+    }
+}
+
+// draws `c` with its top left pixel at `dst` in `color`; background pixels
+// are `background` if `opaque`, otherwise left as they are
+auto inline glyph(bool const avx2, u32* const dst, u32 const stride,
+                  char const c, u32 const scale, u32 const color,
+                  u32 const background = 0, bool const opaque = false)
+    -> void {
+    if (scale > MAX_SCALE) {
+        glyph_large(dst, stride, c, scale, color, background, opaque);
+    } else if (avx2) {
+        glyph_avx2(dst, stride, c, scale, color, background, opaque);
+    } else {
+        glyph_scalar(dst, stride, c, scale, color, background, opaque);
+    }
+}
+
+} // namespace font
@@ -0,0 +1,692 @@
+#pragma once
+
+#include "types.hpp"
+
+// mandelbrot escape-time kernels
+//
+// note: every kernel computes the same operations in the same order one per
+//       statement so clang does not contract them into fma (contraction is
+//       limited to single expressions); vector results then equal the scalar
+//       reference bit for bit
+namespace fractal {
+
+// iterations before a pixel counts as inside the set
+auto constexpr MAX_ITERATIONS = 128u;
+
+// pixel (x, y) maps to c = (min_re + x * re_step, max_im - y * im_step)
+struct View {
+    f32 min_re;
+    f32 max_im;
+    f32 re_step;
+    f32 im_step;
+};
+
+// zooms into a fixed target; `frame` is the zoom step
+auto inline view(u32 const width, u32 const height, u32 const frame) -> View {
+    auto const target_re = -0.743643f;
+    auto const target_im = 0.131825f;
+
+    // zoom scale shrinks as frame increases
+    auto zoom = 1.0f;
+    for (auto i = 0u; i < (frame % 500u); ++i) {
+        zoom *= 0.95f;
+    }
+
+    auto const w = 3.5f * zoom;
+    auto const h = 2.0f * zoom;
+    auto const min_re = target_re - w / 2.0f;
+    auto const max_re = target_re + w / 2.0f;
+    auto const min_im = target_im - h / 2.0f;
+    auto const max_im = target_im + h / 2.0f;
+
+    return {.min_re = min_re,
+            .max_im = max_im,
+            .re_step = (max_re - min_re) / f32(width - 1u),
+            .im_step = (max_im - min_im) / f32(height - 1u)};
+}
+
+// selected once at start from cpu features
+enum class Simd : u8 { SCALAR, AVX2, AVX512 };
+
+// pixels per call of `row`; multiple of the widest kernel
+auto constexpr CHUNK = 64u;
+
+// reference kernel: one pixel at a time
+// note: the row kernels compute pixels x0, x0 + stride, x0 + 2 * stride, ...
+auto inline row_scalar(View const& v, u32 const x0, u32 const y,
+                       u32 const count, u32* const out, u32 const stride = 1)
+    -> void {
+    auto const y_step = f32(y) * v.im_step;
+    auto const c_im = v.max_im - y_step;
+    for (auto i = 0u; i < count; ++i) {
+        auto const x_step = f32(x0 + i * stride) * v.re_step;
+        auto const c_re = v.min_re + x_step;
+
+        auto z_re = c_re;
+        auto z_im = c_im;
+        auto n = 0u;
+        while (n < MAX_ITERATIONS) {
+            auto const re2 = z_re * z_re;
+            auto const im2 = z_im * z_im;
+            auto const mag = re2 + im2;
+            if (!(mag <= 4.0f)) {
+                break;
+            }
+            auto const re = re2 - im2;
+            auto const two_re = 2.0f * z_re;
+            auto const im = two_re * z_im;
+            z_re = re + c_re;
+            z_im = im + c_im;
+            ++n;
+        }
+        out[i] = n;
+    }
+}
+
+// escape-time of pixel (x, y) with interior shortcuts
+//  * points in the main cardioid or the period-2 bulb are inside without
+//    iterating
+//  * an orbit that returns exactly to a saved point is periodic and never
+//    escapes; the saved point moves at doubling intervals (brent)
+// note: equals `row_scalar` except for points the bulb tests round inside
+auto inline point(View const& v, u32 const x, u32 const y) -> u32 {
+    auto const x_step = f32(x) * v.re_step;
+    auto const c_re = v.min_re + x_step;
+    auto const y_step = f32(y) * v.im_step;
+    auto const c_im = v.max_im - y_step;
+
+    // period-2 bulb: (re + 1)^2 + im^2 <= 1/16
+    auto const c_im2 = c_im * c_im;
+    auto const re1 = c_re + 1.0f;
+    if (re1 * re1 + c_im2 <= 0.0625f) {
+        return MAX_ITERATIONS;
+    }
+
+    // main cardioid: q (q + (re - 1/4)) <= im^2 / 4 where
+    // q = (re - 1/4)^2 + im^2
+    auto const re4 = c_re - 0.25f;
+    auto const q = re4 * re4 + c_im2;
+    if (q * (q + re4) <= 0.25f * c_im2) {
+        return MAX_ITERATIONS;
+    }
+
+    auto z_re = c_re;
+    auto z_im = c_im;
+    auto saved_re = z_re;
+    auto saved_im = z_im;
+    auto save_at = 8u;
+    auto n = 0u;
+    while (n < MAX_ITERATIONS) {
+        auto const re2 = z_re * z_re;
+        auto const im2 = z_im * z_im;
+        auto const mag = re2 + im2;
+        if (!(mag <= 4.0f)) {
+            break;
+        }
+        auto const re = re2 - im2;
+        auto const two_re = 2.0f * z_re;
+        auto const im = two_re * z_im;
+        z_re = re + c_re;
+        z_im = im + c_im;
+        ++n;
+
+        if (z_re == saved_re && z_im == saved_im) {
+            return MAX_ITERATIONS;
+        }
+        if (n == save_at) {
+            saved_re = z_re;
+            saved_im = z_im;
+            save_at *= 2;
+        }
+    }
+    return n;
+}
+
+namespace detail {
+
+using f32x8 = f32 __attribute__((vector_size(32)));
+using i32x8 = i32 __attribute__((vector_size(32)));
+using f32x16 = f32 __attribute__((vector_size(64)));
+using i32x16 = i32 __attribute__((vector_size(64)));
+
+} // namespace detail
+
+namespace detail {
+
+// escape-time of 8 points in ymm registers
+// note: escaped lanes keep iterating but stop counting; the loop exits once
+//       every lane has escaped
+[[gnu::target("avx2")]] auto inline escape_avx2(f32x8 const c_re,
+                                                f32x8 const c_im) -> i32x8 {
+    auto z_re = c_re;
+    auto z_im = c_im;
+    auto n = i32x8{};
+    // lanes still iterating are -1
+    auto active = i32x8{} - 1;
+    for (auto i = 0u; i < MAX_ITERATIONS; ++i) {
+        auto const re2 = z_re * z_re;
+        auto const im2 = z_im * z_im;
+        auto const mag = re2 + im2;
+        active &= mag <= 4.0f;
+        auto const mask = __builtin_bit_cast(f32x8, active);
+        if (!__builtin_ia32_movmskps256(mask)) {
+            break;
+        }
+        n -= active;
+        auto const re = re2 - im2;
+        auto const two_re = 2.0f * z_re;
+        auto const im = two_re * z_im;
+        z_re = re + c_re;
+        z_im = im + c_im;
+    }
+    return n;
+}
+
+// escape-time of 16 points in zmm registers; same as `escape_avx2`
+[[gnu::target("avx512f")]] auto inline escape_avx512(f32x16 const c_re,
+                                                     f32x16 const c_im)
+    -> i32x16 {
+    auto z_re = c_re;
+    auto z_im = c_im;
+    auto n = i32x16{};
+    // lanes still iterating are -1
+    auto active = i32x16{} - 1;
+    for (auto i = 0u; i < MAX_ITERATIONS; ++i) {
+        auto const re2 = z_re * z_re;
+        auto const im2 = z_im * z_im;
+        auto const mag = re2 + im2;
+        active &= mag <= 4.0f;
+        // predicate 4: not equal
+        if (!__builtin_ia32_cmpd512_mask(active, i32x16{}, 4, 0xffff)) {
+            break;
+        }
+        n -= active;
+        auto const re = re2 - im2;
+        auto const two_re = 2.0f * z_re;
+        auto const im = two_re * z_im;
+        z_re = re + c_re;
+        z_im = im + c_im;
+    }
+    return n;
+}
+
+} // namespace detail
+
+// 8 pixels per iteration in ymm registers; lanes past `count` are computed
+// and discarded
+[[gnu::target("avx2")]] auto inline row_avx2(View const& v, u32 const x0,
+                                             u32 const y, u32 const count,
+                                             u32* const out,
+                                             u32 const stride = 1) -> void {
+    using detail::f32x8;
+
+    auto const lane = f32x8{0, 1, 2, 3, 4, 5, 6, 7} * f32(stride);
+    auto const y_step = f32(y) * v.im_step;
+    auto const c_im = f32x8{} + (v.max_im - y_step);
+
+    for (auto x = 0u; x < count; x += 8) {
+        auto const xs = lane + f32(x0 + x * stride);
+        auto const x_step = xs * v.re_step;
+        auto const c_re = v.min_re + x_step;
+
+        auto const n = detail::escape_avx2(c_re, c_im);
+
+        auto const valid = count - x < 8 ? count - x : 8u;
+        for (auto i = 0u; i < valid; ++i) {
+            out[x + i] = u32(n[i]);
+        }
+    }
+}
+
+// 16 pixels per iteration in zmm registers; same as `row_avx2`
+[[gnu::target("avx512f")]] auto inline row_avx512(View const& v, u32 const x0,
+                                                  u32 const y, u32 const count,
+                                                  u32* const out,
+                                                  u32 const stride = 1)
+    -> void {
+    using detail::f32x16;
+
+    auto const lane =
+        f32x16{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15} *
+        f32(stride);
+    auto const y_step = f32(y) * v.im_step;
+    auto const c_im = f32x16{} + (v.max_im - y_step);
+
+    for (auto x = 0u; x < count; x += 16) {
+        auto const xs = lane + f32(x0 + x * stride);
+        auto const x_step = xs * v.re_step;
+        auto const c_re = v.min_re + x_step;
+
+        auto const n = detail::escape_avx512(c_re, c_im);
+
+        auto const valid = count - x < 16 ? count - x : 16u;
+        for (auto i = 0u; i < valid; ++i) {
+            out[x + i] = u32(n[i]);
+        }
+    }
+}
+
+// iteration counts of `count` (at most `CHUNK`) pixels `stride` apart
+// starting at (x0, y)
+auto inline row(Simd const simd, View const& v, u32 const x0, u32 const y,
+                u32 const count, u32* const out, u32 const stride = 1)
+    -> void {
+    switch (simd) {
+    case Simd::AVX512:
+        row_avx512(v, x0, y, count, out, stride);
+        break;
+    case Simd::AVX2:
+        row_avx2(v, x0, y, count, out, stride);
+        break;
+    case Simd::SCALAR:
+        row_scalar(v, x0, y, count, out, stride);
+        break;
+    }
+}
+
+// one pixel at a time down a column; same as `row_scalar`
+auto inline column_scalar(View const& v, u32 const x, u32 const y0,
+                          u32 const count, u32* const out) -> void {
+    for (auto i = 0u; i < count; ++i) {
+        row_scalar(v, x, y0 + i, 1, out + i);
+    }
+}
+
+// 8 pixels of a column per iteration; same as `row_avx2`
+[[gnu::target("avx2")]] auto inline column_avx2(View const& v, u32 const x,
+                                                u32 const y0, u32 const count,
+                                                u32* const out) -> void {
+    using detail::f32x8;
+
+    auto const lane = f32x8{0, 1, 2, 3, 4, 5, 6, 7};
+    auto const x_step = f32(x) * v.re_step;
+    auto const c_re = f32x8{} + (v.min_re + x_step);
+
+    for (auto y = 0u; y < count; y += 8) {
+        auto const ys = lane + f32(y0 + y);
+        auto const y_step = ys * v.im_step;
+        auto const c_im = v.max_im - y_step;
+
+        auto const n = detail::escape_avx2(c_re, c_im);
+
+        auto const valid = count - y < 8 ? count - y : 8u;
+        for (auto i = 0u; i < valid; ++i) {
+            out[y + i] = u32(n[i]);
+        }
+    }
+}
+
+// 16 pixels of a column per iteration; same as `row_avx512`
+[[gnu::target("avx512f")]] auto inline column_avx512(View const& v,
+                                                     u32 const x, u32 const y0,
+                                                     u32 const count,
+                                                     u32* const out) -> void {
+    using detail::f32x16;
+
+    auto const lane =
+        f32x16{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    auto const x_step = f32(x) * v.re_step;
+    auto const c_re = f32x16{} + (v.min_re + x_step);
+
+    for (auto y = 0u; y < count; y += 16) {
+        auto const ys = lane + f32(y0 + y);
+        auto const y_step = ys * v.im_step;
+        auto const c_im = v.max_im - y_step;
+
+        auto const n = detail::escape_avx512(c_re, c_im);
+
+        auto const valid = count - y < 16 ? count - y : 16u;
+        for (auto i = 0u; i < valid; ++i) {
+            out[y + i] = u32(n[i]);
+        }
+    }
+}
+
+// iteration counts of `count` (at most `CHUNK`) pixels starting at (x, y0)
+// going down
+auto inline column(Simd const simd, View const& v, u32 const x, u32 const y0,
+                   u32 const count, u32* const out) -> void {
+    switch (simd) {
+    case Simd::AVX512:
+        column_avx512(v, x, y0, count, out);
+        break;
+    case Simd::AVX2:
+        column_avx2(v, x, y0, count, out);
+        break;
+    case Simd::SCALAR:
+        column_scalar(v, x, y0, count, out);
+        break;
+    }
+}
+
+auto inline simd_name(Simd const simd) -> char const* {
+    switch (simd) {
+    case Simd::AVX512:
+        return "avx512";
+    case Simd::AVX2:
+        return "avx2";
+    case Simd::SCALAR:
+        return "scalar";
+    }
+    return "";
+}
+
+//
+// deep zoom by perturbation
+//
+// one reference orbit Z at the view center is computed in double-double
+// precision and stored rounded to f64; every pixel c = C + dc iterates only
+// its f64 difference dz to the reference:
+//   dz' = 2 Z dz + dz^2 + dc
+//
+// glitch: once |Z + dz| < |dz| the difference dominates and f64 loses the
+// precision perturbation relies on; such a pixel, and one running past the
+// end of the reference orbit, re-references to the orbit's start with
+// dz = Z + dz (rebasing)
+//
+
+// iteration limit grows with zoom depth up to this
+auto constexpr DEEP_MAX_ITERATIONS = 2048u;
+
+// pixel (x, y) maps to c = center + ((x - x_center) * re_step,
+// (y_center - y) * im_step)
+struct DeepView {
+    f64 center_re;
+    f64 center_im;
+    f64 re_step;
+    f64 im_step;
+    f64 x_center;
+    f64 y_center;
+    u32 max_iterations;
+};
+
+// same zoom as `view` in f64
+auto inline deep_view(u32 const width, u32 const height, u32 const frame)
+    -> DeepView {
+    auto const step = frame % 500u;
+    auto zoom = 1.0;
+    for (auto i = 0u; i < step; ++i) {
+        zoom *= 0.95;
+    }
+    auto const iterations = MAX_ITERATIONS + 4 * step;
+
+    return {.center_re = f64(-0.743643f),
+            .center_im = f64(0.131825f),
+            .re_step = 3.5 * zoom / f64(width - 1u),
+            .im_step = 2.0 * zoom / f64(height - 1u),
+            .x_center = f64(width - 1u) / 2.0,
+            .y_center = f64(height - 1u) / 2.0,
+            .max_iterations = iterations < DEEP_MAX_ITERATIONS
+                                  ? iterations
+                                  : DEEP_MAX_ITERATIONS};
+}
+
+// reference orbit Z_0 = 0, Z_1 = C, ... up to `length`; ends early at the
+// first |Z| > 2
+struct Orbit {
+    f64 re[DEEP_MAX_ITERATIONS + 1];
+    f64 im[DEEP_MAX_ITERATIONS + 1];
+    u32 length;
+};
+
+// unevaluated sum hi + lo with |lo| <= ulp(hi) / 2
+struct DoubleDouble {
+    f64 hi;
+    f64 lo;
+};
+
+namespace detail {
+
+// exact a + b (knuth)
+auto inline two_sum(f64 const a, f64 const b) -> DoubleDouble {
+    auto const s = a + b;
+    auto const bb = s - a;
+    auto const a_err = a - (s - bb);
+    auto const b_err = b - bb;
+    return {s, a_err + b_err};
+}
+
+// exact a * b without fma (dekker)
+auto inline two_product(f64 const a, f64 const b) -> DoubleDouble {
+    auto constexpr SPLIT = 134217729.0; // 2^27 + 1
+    auto const ta = SPLIT * a;
+    auto const a_hi = ta - (ta - a);
+    auto const a_lo = a - a_hi;
+    auto const tb = SPLIT * b;
+    auto const b_hi = tb - (tb - b);
+    auto const b_lo = b - b_hi;
+    auto const p = a * b;
+    auto const e1 = a_hi * b_hi - p;
+    auto const e2 = e1 + a_hi * b_lo;
+    auto const e3 = e2 + a_lo * b_hi;
+    return {p, e3 + a_lo * b_lo};
+}
+
+auto inline normalize(f64 const hi, f64 const lo) -> DoubleDouble {
+    auto const s = hi + lo;
+    return {s, lo - (s - hi)};
+}
+
+auto inline add(DoubleDouble const a, DoubleDouble const b) -> DoubleDouble {
+    auto const s = two_sum(a.hi, b.hi);
+    auto const t = two_sum(a.lo, b.lo);
+    auto const u = normalize(s.hi, s.lo + t.hi);
+    return normalize(u.hi, u.lo + t.lo);
+}
+
+auto inline mul(DoubleDouble const a, DoubleDouble const b) -> DoubleDouble {
+    auto const p = two_product(a.hi, b.hi);
+    auto const cross = a.hi * b.lo + a.lo * b.hi;
+    return normalize(p.hi, p.lo + cross);
+}
+
+} // namespace detail
+
+// computes the reference orbit at the view center
+auto inline reference_orbit(DeepView const& v, Orbit& orbit) -> void {
+    using detail::add;
+    using detail::mul;
+
+    auto const c_re = DoubleDouble{v.center_re, 0};
+    auto const c_im = DoubleDouble{v.center_im, 0};
+    auto z_re = DoubleDouble{0, 0};
+    auto z_im = DoubleDouble{0, 0};
+
+    orbit.re[0] = 0;
+    orbit.im[0] = 0;
+    auto n = 0u;
+    while (n < v.max_iterations) {
+        // z^2 + c
+        auto const re2 = mul(z_re, z_re);
+        auto const im2 = mul(z_im, z_im);
+        auto const re_im = mul(z_re, z_im);
+        z_re = add(add(re2, {-im2.hi, -im2.lo}), c_re);
+        z_im = add(add(re_im, re_im), c_im);
+        ++n;
+
+        orbit.re[n] = z_re.hi + z_re.lo;
+        orbit.im[n] = z_im.hi + z_im.lo;
+        if (orbit.re[n] * orbit.re[n] + orbit.im[n] * orbit.im[n] > 4.0) {
+            break;
+        }
+    }
+    orbit.length = n;
+}
+
+// reference kernel: one pixel at a time
+// note: same operations in the same order as `deep_row_avx2`
+auto inline deep_row_scalar(DeepView const& v, Orbit const& orbit,
+                            u32 const x0, u32 const y, u32 const count,
+                            u32* const out) -> void {
+    auto const dy = v.y_center - f64(y);
+    auto const dc_im = dy * v.im_step;
+    for (auto i = 0u; i < count; ++i) {
+        auto const dx = f64(x0 + i) - v.x_center;
+        auto const dc_re = dx * v.re_step;
+
+        auto dz_re = 0.0;
+        auto dz_im = 0.0;
+        auto m = 0u;
+        auto n = 0u;
+        while (n < v.max_iterations) {
+            // dz' = 2 Z dz + dz^2 + dc
+            auto const zr = orbit.re[m];
+            auto const zi = orbit.im[m];
+            auto const a = zr * dz_re;
+            auto const b = zi * dz_im;
+            auto const c = zr * dz_im;
+            auto const d = zi * dz_re;
+            auto const dr2 = dz_re * dz_re;
+            auto const di2 = dz_im * dz_im;
+            auto const dri = dz_re * dz_im;
+            auto const lin_re = a - b;
+            auto const lin_im = c + d;
+            auto const sq_re = dr2 - di2;
+            auto const sq_im = dri + dri;
+            auto const t_re = lin_re + lin_re;
+            auto const t_im = lin_im + lin_im;
+            auto const u_re = t_re + sq_re;
+            auto const u_im = t_im + sq_im;
+            dz_re = u_re + dc_re;
+            dz_im = u_im + dc_im;
+            ++m;
+
+            auto const z_re = orbit.re[m] + dz_re;
+            auto const z_im = orbit.im[m] + dz_im;
+            auto const zr2 = z_re * z_re;
+            auto const zi2 = z_im * z_im;
+            auto const mag = zr2 + zi2;
+            if (!(mag <= 4.0)) {
+                break;
+            }
+            ++n;
+
+            auto const dzr2 = dz_re * dz_re;
+            auto const dzi2 = dz_im * dz_im;
+            auto const dz_mag = dzr2 + dzi2;
+            if (mag < dz_mag || m == orbit.length) {
+                dz_re = z_re;
+                dz_im = z_im;
+                m = 0;
+            }
+        }
+        out[i] = n;
+    }
+}
+
+namespace detail {
+
+using f64x4 = f64 __attribute__((vector_size(32)));
+using i64x4 = i64 __attribute__((vector_size(32)));
+
+// lanes of `a` where `mask` is -1, otherwise of `b`
+[[gnu::target("avx2")]] auto inline select(i64x4 const mask, f64x4 const a,
+                                           f64x4 const b) -> f64x4 {
+    auto const bits = (mask & __builtin_bit_cast(i64x4, a)) |
+                      (~mask & __builtin_bit_cast(i64x4, b));
+    return __builtin_bit_cast(f64x4, bits);
+}
+
+} // namespace detail
+
+// 4 pixels per iteration in ymm registers; lanes past `count` are computed
+// and discarded
+// note: each lane has its own reference index after rebasing so orbit values
+//       are loaded per lane
+[[gnu::target("avx2")]] auto inline deep_row_avx2(DeepView const& v,
+                                                  Orbit const& orbit,
+                                                  u32 const x0, u32 const y,
+                                                  u32 const count,
+                                                  u32* const out) -> void {
+    using detail::f64x4;
+    using detail::i64x4;
+
+    auto const lane = f64x4{0, 1, 2, 3};
+    auto const dy = v.y_center - f64(y);
+    auto const dc_im = f64x4{} + dy * v.im_step;
+    auto const length = i64x4{} + i64(orbit.length);
+
+    for (auto x = 0u; x < count; x += 4) {
+        auto const xs = lane + f64(x0 + x);
+        auto const dx = xs - v.x_center;
+        auto const dc_re = dx * v.re_step;
+
+        auto dz_re = f64x4{};
+        auto dz_im = f64x4{};
+        auto m = i64x4{};
+        auto n = i64x4{};
+        // lanes still iterating are -1
+        auto active = i64x4{} - 1;
+        for (auto i = 0u; i < v.max_iterations; ++i) {
+            auto zr = f64x4{};
+            auto zi = f64x4{};
+            for (auto l = 0u; l < 4; ++l) {
+                zr[l] = orbit.re[m[l]];
+                zi[l] = orbit.im[m[l]];
+            }
+            auto const a = zr * dz_re;
+            auto const b = zi * dz_im;
+            auto const c = zr * dz_im;
+            auto const d = zi * dz_re;
+            auto const dr2 = dz_re * dz_re;
+            auto const di2 = dz_im * dz_im;
+            auto const dri = dz_re * dz_im;
+            auto const lin_re = a - b;
+            auto const lin_im = c + d;
+            auto const sq_re = dr2 - di2;
+            auto const sq_im = dri + dri;
+            auto const t_re = lin_re + lin_re;
+            auto const t_im = lin_im + lin_im;
+            auto const u_re = t_re + sq_re;
+            auto const u_im = t_im + sq_im;
+            dz_re = u_re + dc_re;
+            dz_im = u_im + dc_im;
+            m += 1;
+
+            for (auto l = 0u; l < 4; ++l) {
+                zr[l] = orbit.re[m[l]];
+                zi[l] = orbit.im[m[l]];
+            }
+            auto const z_re = zr + dz_re;
+            auto const z_im = zi + dz_im;
+            auto const zr2 = z_re * z_re;
+            auto const zi2 = z_im * z_im;
+            auto const mag = zr2 + zi2;
+            active &= __builtin_bit_cast(i64x4, mag <= 4.0);
+            auto const mask = __builtin_bit_cast(f64x4, active);
+            if (!__builtin_ia32_movmskpd256(mask)) {
+                break;
+            }
+            n -= active;
+
+            auto const dzr2 = dz_re * dz_re;
+            auto const dzi2 = dz_im * dz_im;
+            auto const dz_mag = dzr2 + dzi2;
+            // note: comparison lanes are `long` on some targets
+            auto const rebase =
+                __builtin_bit_cast(i64x4, (mag < dz_mag) | (m == length));
+            dz_re = detail::select(rebase, z_re, dz_re);
+            dz_im = detail::select(rebase, z_im, dz_im);
+            m &= ~rebase;
+        }
+
+        auto const valid = count - x < 4 ? count - x : 4u;
+        for (auto l = 0u; l < valid; ++l) {
+            out[x + l] = u32(n[l]);
+        }
+    }
+}
+
+// iteration counts of `count` (at most `CHUNK`) pixels starting at (x0, y)
+// note: avx-512 cpus use the avx2 kernel
+auto inline deep_row(Simd const simd, DeepView const& v, Orbit const& orbit,
+                     u32 const x0, u32 const y, u32 const count,
+                     u32* const out) -> void {
+    if (simd == Simd::SCALAR) {
+        deep_row_scalar(v, orbit, x0, y, count, out);
+    } else {
+        deep_row_avx2(v, orbit, x0, y, count, out);
+    }
+}
+
+} // namespace fractal
@@ -3,6 +3,7 @@
 #include "atomic.hpp"
 #include "config.hpp"
 #include "kernel.hpp"
+#include "memory.hpp"
 
 // * unexpected conditions reboot the system
 // * no recovery paths implemented
@@ -15,7 +16,77 @@ namespace {
 auto constexpr PAGE_4K = 0x1000ull;
 
 // note: stack must be 16 byte aligned and top of stack sets RSP
-alignas(16) u8 kernel_stack[PAGE_4K];
+// note: same size as application processor stacks; interrupts push up to a
+//       few KB of extended state with avx-512
+alignas(16) u8 kernel_stack[config::CORE_STACK_SIZE_PAGES * PAGE_4K];
+
+// interrupt entry extended state save in `kernel_asm.s`
+extern "C" u64 kernel_asm_xsave_size;
+extern "C" u64 kernel_asm_xsave_mask;
+extern "C" u64 kernel_asm_xsave_mode;
+
+// xcr0 components
+//  bits name       description
+//     0 x87        standard fpu state
+//     1 sse        xmm registers
+//     2 avx        ymm registers (upper 128 bits)
+//     5 opmask     avx-512 k0-k7
+//     6 zmm_hi256  zmm0-15 (upper 256 bits)
+//     7 hi16_zmm   zmm16-31
+auto constexpr XCR0_AVX = 0x07ull;
+auto constexpr XCR0_AVX512 = 0xe0ull;
+
+// selects xcr0 components from cpuid leaf 0xd and sizes the interrupt save
+// area for them
+// note: bsp only, before `init_fpu`; sizes are computed from the component
+//       layout so xcr0 need not be set yet
+auto inline init_xsave() -> void {
+    auto const supported = core::cpuid(0xd).eax;
+
+    auto mask = XCR0_AVX;
+    if (config::USE_AVX512 && (supported & XCR0_AVX512) == XCR0_AVX512) {
+        mask |= XCR0_AVX512;
+    }
+
+    // eax bit 1: xsavec
+    auto const has_xsavec = (core::cpuid(0xd, 1).eax & (1u << 1)) != 0;
+
+    // legacy region (512) and header (64) followed by the components
+    // subleaf `i`: eax size, ebx standard offset, ecx bit 1 64 byte aligned
+    // when compacted
+    auto standard = 576u;
+    auto compacted = 576u;
+    for (auto i = 2u; i < 64; ++i) {
+        if (!(mask & (1ull << i))) {
+            continue;
+        }
+        auto const c = core::cpuid(0xd, i);
+        if (c.ebx + c.eax > standard) {
+            standard = c.ebx + c.eax;
+        }
+        if (c.ecx & (1u << 1)) {
+            compacted = (compacted + 63) & ~63u;
+        }
+        compacted += c.eax;
+    }
+
+    auto const size = has_xsavec ? compacted : standard;
+    kernel_asm_xsave_size = (size + 63) & ~63ull;
+    kernel_asm_xsave_mask = mask;
+    kernel_asm_xsave_mode = has_xsavec ? 1 : 0;
+
+    // cpuid leaf 7 ebx bit 5: avx2
+    fpu = {.xcr0 = mask,
+           .save_bytes = kernel_asm_xsave_size,
+           .avx2 = (core::cpuid(7).ebx & (1u << 5)) != 0,
+           .avx512 = (mask & XCR0_AVX512) != 0};
+
+    serial::print("  xcr0: ");
+    serial::print_hex_byte(u8(mask));
+    serial::print(", interrupt save area: ");
+    serial::print_dec(kernel_asm_xsave_size);
+    serial::print(has_xsavec ? " bytes (xsavec)\n" : " bytes (xsave)\n");
+}
 
 // serial (uart) init
 auto inline init_serial() -> void {
@@ -52,12 +123,9 @@ auto inline init_fpu() -> void {
     asm volatile("mov %0, %%cr4" : : "r"(cr4));
 
     // xcr0: extended control register 0
-    //  bits name   description
-    //     0 x87    standard fpu state
-    //     1 sse    xmm registers
-    //     2 avx    ymm registers (upper 128 bits)
-    auto const eax = (1u << 0) | (1u << 1) | (1u << 2);
-    auto const edx = 0u;
+    // note: components selected by `init_xsave`
+    auto const eax = u32(kernel_asm_xsave_mask);
+    auto const edx = u32(kernel_asm_xsave_mask >> 32);
     asm volatile("xsetbv" : : "a"(eax), "d"(edx), "c"(0));
 
     // mxcsr: control/status register for sse
@@ -108,13 +176,46 @@ auto inline init_gdt() -> void {
 
 auto constexpr PAGE_2M = 0x20'0000ull;
 
-// heap (bump allocator) init
-// finds the largest contiguous usable memory chunk and aligns to page
-// boundaries
-auto inline init_heap() -> void {
-    auto aligned_start = 0ull;
-    auto aligned_size = 0ull;
-    auto max_size = 0ull;
+// bsp init
+// makes the bsp core index 0; application processors get 1 and up in the
+// order they take a ticket in `init_cores`
+// note: the aps write their own apic id into the slot of their ticket
+auto inline init_bsp() -> void {
+    auto const bsp_id = core::apic_id();
+    for (auto i = 0u; i < core_count; ++i) {
+        if (cores[i].apic_id == bsp_id) {
+            cores[i] = cores[0];
+            cores[0] = {.apic_id = bsp_id,
+                        .index = 0,
+                        .node = numa.apic_node[bsp_id]};
+            break;
+        }
+    }
+
+    core::set_index(0);
+}
+
+auto constexpr PAGE_1G = 0x4000'0000ull;
+
+// uefi memory types free for the page allocator
+enum class FreeMemory : u8 {
+    // conventional memory; free from the start
+    CONVENTIONAL,
+    // boot services code and data; may hold the firmware's page tables, which
+    // are live until `init_paging` switches cr3
+    BOOT_SERVICES,
+    ALL,
+};
+
+// calls `f(start, end)` for every page aligned range of `type` free for the
+// page allocator
+// excluded:
+//  * memory below 1MB (trampoline and real mode structures)
+//  * the descriptor holding the current (uefi provided) stack; in use until
+//    `osca_start` pivots to `kernel_stack`
+template <typename F>
+auto for_each_free_range(FreeMemory const type, F f) -> void {
+    auto const stack = uptr(__builtin_frame_address(0));
 
     auto const* const desc = ptr<EFI_MEMORY_DESCRIPTOR>(memory_map.buffer);
     auto const num_descriptors = memory_map.size / memory_map.descriptor_size;
@@ -123,31 +224,152 @@ auto inline init_heap() -> void {
         auto const* const d = ptr_offset<EFI_MEMORY_DESCRIPTOR>(
             uptr(desc), i * memory_map.descriptor_size);
 
-        if (d->Type == EfiConventionalMemory ||
-            d->Type == EfiBootServicesCode || d->Type == EfiBootServicesData) {
+        auto const is_conventional = d->Type == EfiConventionalMemory;
+        auto const is_boot_services =
+            d->Type == EfiBootServicesCode || d->Type == EfiBootServicesData;
+        auto const is_free =
+            (type != FreeMemory::BOOT_SERVICES && is_conventional) ||
+            (type != FreeMemory::CONVENTIONAL && is_boot_services);
+        if (!is_free) {
+            continue;
+        }
+
+        auto const chunk_start = d->PhysicalStart;
+        auto const chunk_end = chunk_start + (d->NumberOfPages * PAGE_4K);
 
-            auto const chunk_start = d->PhysicalStart;
-            auto const chunk_end = chunk_start + (d->NumberOfPages * PAGE_4K);
+        if (stack >= chunk_start && stack < chunk_end) {
+            continue;
+        }
 
-            // align start up; align end down; ensures heap is within physical
-            // bounds
-            auto const current_start =
-                (chunk_start + PAGE_4K - 1) & ~(PAGE_4K - 1);
-            auto const current_end = chunk_end & ~(PAGE_4K - 1);
+        // align start up; align end down; ensures range is within physical
+        // bounds
+        auto start = (chunk_start + PAGE_4K - 1) & ~(PAGE_4K - 1);
+        auto const end = chunk_end & ~(PAGE_4K - 1);
 
-            if (current_end > current_start) {
-                auto const current_size = current_end - current_start;
-                if (current_size > max_size) {
-                    max_size = current_size;
-                    aligned_start = current_start;
-                    aligned_size = current_size;
-                }
+        if (start < 0x10'0000) {
+            start = 0x10'0000;
+        }
+
+        if (end > start) {
+            f(start, end);
+        }
+    }
+}
+
+// calls `f(start, end)` for every free range on numa `node`
+// note: without srat every range is on node 0; with srat memory outside its
+//       ranges is not used
+template <typename F>
+auto for_each_free_range_on(u32 const node, FreeMemory const type, F f)
+    -> void {
+    for_each_free_range(type, [&](uptr const start, uptr const end) {
+        if (numa.range_count == 0) {
+            f(start, end);
+            return;
+        }
+        for (auto i = 0u; i < numa.range_count; ++i) {
+            auto const& r = numa.ranges[i];
+            if (r.node != node) {
+                continue;
+            }
+            // intersection aligned to pages
+            auto const s = ((start > r.start ? start : r.start) + PAGE_4K - 1) &
+                           ~(PAGE_4K - 1);
+            auto const e = (end < r.end ? end : r.end) & ~(PAGE_4K - 1);
+            if (e > s) {
+                f(s, e);
             }
         }
+    });
+}
+
+// page allocator init
+// builds a buddy allocator per numa node spanning every free range of the node
+// and adds the node's conventional memory; boot services memory follows in
+// `add_boot_services_memory` once cr3 no longer points into it
+// metadata (one byte per page in span) is taken from the node's largest
+// conventional range
+auto inline init_heap() -> void {
+    for (auto node = 0u; node < numa.node_count; ++node) {
+        auto span_start = ~0ull;
+        auto span_end = 0ull;
+        auto largest_start = 0ull;
+        auto largest_size = 0ull;
+
+        for_each_free_range_on(
+            node, FreeMemory::ALL, [&](uptr const start, uptr const end) {
+                span_start = start < span_start ? start : span_start;
+                span_end = end > span_end ? end : span_end;
+            });
+        for_each_free_range_on(node, FreeMemory::CONVENTIONAL,
+                               [&](uptr const start, uptr const end) {
+                                   if (end - start > largest_size) {
+                                       largest_start = start;
+                                       largest_size = end - start;
+                                   }
+                               });
+
+        // note: nodes without memory allocate from the nearest node
+        if (largest_size == 0) {
+            continue;
+        }
+
+        auto const base = span_start & ~(PAGE_1G - 1);
+        auto const page_count = (span_end - base) / PAGE_4K;
+        auto const meta_end =
+            (largest_start + page_count + PAGE_4K - 1) & ~(PAGE_4K - 1);
+
+        // note: the largest range is the only candidate
+        if (meta_end > largest_start + largest_size) {
+            serial::print("abort: page metadata does not fit in the largest "
+                          "conventional range of node ");
+            serial::print_dec(node);
+            serial::print("\n");
+            panic(0x00'00'ff'ff); // cyan
+        }
+
+        auto& frames = memory::frames[node];
+        frames.init(base, page_count, ptr<u8>(largest_start));
+
+        for_each_free_range_on(node, FreeMemory::CONVENTIONAL,
+                               [&](uptr start, uptr const end) {
+                                   // skip metadata
+                                   if (start == largest_start) {
+                                       start = meta_end;
+                                   }
+                                   if (end > start) {
+                                       frames.add(start, end);
+                                   }
+                               });
+
+        serial::print("  node ");
+        serial::print_dec(node);
+        serial::print(" pages: ");
+        serial::print_dec(frames.free_bytes() / 1024);
+        serial::print(" KB\n");
     }
+}
 
-    // note: assumes heap was found
-    heap = {ptr<void>(aligned_start), aligned_size};
+// adds boot services code and data to the page allocators
+// note: called after `init_paging` activated the kernel's page tables; the
+//       firmware's tables may be in this memory
+auto inline add_boot_services_memory() -> void {
+    for (auto node = 0u; node < numa.node_count; ++node) {
+        auto& frames = memory::frames[node];
+        // note: nodes without conventional memory have no allocator
+        if (frames.total_bytes() == 0) {
+            continue;
+        }
+        for_each_free_range_on(
+            node, FreeMemory::BOOT_SERVICES,
+            [&](uptr const start, uptr const end) { frames.add(start, end); });
+
+        serial::print("  node ");
+        serial::print_dec(node);
+        serial::print(" pages: ");
+        serial::print_dec(frames.free_bytes() / 1024);
+        serial::print(" KB\n");
+    }
 }
 
 // the top-level PML4 (512GB/entry) potentially covering 256 TB
@@ -163,7 +385,8 @@ auto constexpr PAGE_RW = 1ull << 1;
 // page-level cache disable (pcd): bit 1 of pat index
 auto constexpr PAGE_PCD = 1ull << 4;
 
-// page size (ps): 1 in pde (level 2) indicates 2mb huge page
+// page size (ps): 1 in pde (level 2) indicates 2mb huge page, in pdpe
+// (level 3) 1gb huge page
 auto constexpr PAGE_PS = 1ull << 7;
 
 // pat (page attribute table) bit locations
@@ -173,11 +396,11 @@ auto constexpr PAGE_PS = 1ull << 7;
 // pat bit for 4KB ptes
 auto constexpr PAGE_PAT_4KB = 1ull << 7;
 
-// pat bit for 2MB pdes
+// pat bit for 2MB pdes and 1GB pdpes
 auto constexpr PAGE_PAT_2MB = 1ull << 12;
 
 // bit 12:
-// * for 2MB pages: hardware PAT bit
+// * for 2MB and 1GB pages: hardware PAT bit
 // * for 4KB pages: software signal translated to PAGE_PAT_4KB
 auto constexpr USE_PAT_WC = 1ull << 12;
 
@@ -191,6 +414,7 @@ auto get_next_table(u64* const table, u64 const index) -> u64* {
     if (!(entry & PAGE_P)) {
         // create next level only when needed
         auto const* const next = allocate_pages(1); // zeroed 4KB chunk
+        ++paging.table_pages;
         // link new table: set physical address and flags
         table[index] = uptr(next) | PAGE_P | PAGE_RW;
     }
@@ -212,6 +436,28 @@ auto inline map_range(uptr const phys, u64 const size, u64 const flags)
         auto const pt_idx = (addr >> 12) & 0x1ff;
 
         auto* const pdp = get_next_table(long_mode_pml4, pml4_idx);
+
+        auto const pdpe = pdp[pdp_idx];
+        auto const is_pdpe_present = (pdpe & PAGE_P);
+
+        // check if 1GB mapping is possible and range is unmapped
+        auto const can_use_1gb = paging.uses_1g_pages &&
+                                 (addr & (PAGE_1G - 1)) == 0 &&
+                                 (addr + PAGE_1G <= end) && !is_pdpe_present;
+
+        if (can_use_1gb) {
+            pdp[pdp_idx] = addr | flags | PAGE_PS;
+            ++paging.pages_1g;
+            addr += PAGE_1G;
+            continue;
+        }
+
+        // panic if attempting to map over an existing 1GB page
+        if (is_pdpe_present && (pdpe & PAGE_PS)) {
+            serial::print("error: range already mapped as 1GB\n");
+            panic(0x00'ff'00'ff); // magenta
+        }
+
         auto* const pd = get_next_table(pdp, pdp_idx);
 
         auto const pde = pd[pd_idx];
@@ -224,6 +470,7 @@ auto inline map_range(uptr const phys, u64 const size, u64 const flags)
 
         if (can_use_2mb) {
             pd[pd_idx] = addr | flags | PAGE_PS;
+            ++paging.pages_2m;
             addr += PAGE_2M;
             continue;
         }
@@ -247,6 +494,7 @@ auto inline map_range(uptr const phys, u64 const size, u64 const flags)
             (flags & USE_PAT_WC) ? (flags & ~USE_PAT_WC) | PAGE_PAT_4KB : flags;
 
         pt[pt_idx] = addr | entry_flags;
+        ++paging.pages_4k;
         addr += PAGE_4K;
     }
 }
@@ -255,6 +503,10 @@ auto inline map_range(uptr const phys, u64 const size, u64 const flags)
 auto init_paging() -> void {
     auto trampoline_pages_found = 0u;
 
+    // 1GB pages: cpuid 0x80000001 edx bit 26 (pdpe1gb)
+    paging.uses_1g_pages =
+        config::USE_1G_PAGES && (core::cpuid(0x8000'0001).edx & (1u << 26));
+
     // page attribute flags
     // p: present; rw: read/write
     auto constexpr static RAM_FLAGS = PAGE_P | PAGE_RW;
@@ -266,6 +518,8 @@ auto init_paging() -> void {
     // parse uefi memory map to identity-map system ram and firmware regions
     auto total_mem_B = 0ull;
     auto free_mem_B = 0ull;
+    auto run_start = 0ull;
+    auto run_end = 0ull;
     auto const* const desc = ptr<EFI_MEMORY_DESCRIPTOR>(memory_map.buffer);
     auto const num_descriptors = memory_map.size / memory_map.descriptor_size;
     for (auto i = 0u; i < num_descriptors; ++i) {
@@ -285,7 +539,13 @@ auto init_paging() -> void {
         if (is_ram) {
             auto const size = d->NumberOfPages * PAGE_4K;
 
-            map_range(d->PhysicalStart, size, RAM_FLAGS);
+            // coalesce adjacent descriptors so runs spanning several can use
+            // 1GB and 2MB pages
+            if (d->PhysicalStart != run_end) {
+                map_range(run_start, run_end - run_start, RAM_FLAGS);
+                run_start = d->PhysicalStart;
+            }
+            run_end = d->PhysicalStart + size;
             total_mem_B += size;
 
             // memory that is actually free to use for the heap exclude loader
@@ -313,6 +573,8 @@ auto init_paging() -> void {
         }
     }
 
+    map_range(run_start, run_end - run_start, RAM_FLAGS);
+
     serial::print("  total: ");
     serial::print_dec(total_mem_B / 1024);
     serial::print(" KB\n");
@@ -341,7 +603,24 @@ auto init_paging() -> void {
               FB_FLAGS);
 
     // map the hpet timer
-    map_range(uptr(hpet.address), 0x1000, MMIO_FLAGS);
+    // note: optional when frequencies are enumerated by cpuid
+    if (hpet.address) {
+        map_range(uptr(hpet.address), 0x1000, MMIO_FLAGS);
+    }
+
+    // note: every 1GB page saves the 4KB page directory its 2MB pages need
+    serial::print("  page tables: ");
+    serial::print_dec(paging.table_pages * PAGE_4K / 1024);
+    serial::print(" KB, saved by 1GB pages: ");
+    serial::print_dec(paging.pages_1g * PAGE_4K / 1024);
+    serial::print(" KB\n");
+    serial::print("  pages: 1GB ");
+    serial::print_dec(paging.pages_1g);
+    serial::print(", 2MB ");
+    serial::print_dec(paging.pages_2m);
+    serial::print(", 4KB ");
+    serial::print_dec(paging.pages_4k);
+    serial::print("\n");
 
     // config pat: set pa4 to write-combining (0x01)
     // msr 0x277: ia32_pat register
@@ -366,19 +645,60 @@ auto init_paging() -> void {
     asm volatile("mov %0, %%cr3" : : "r"(long_mode_pml4) : "memory");
 }
 
-auto apic_ticks_per_sec = 0ul;
-auto tsc_ticks_per_sec = 0ull;
+// lapic timer divisor configured in dcr (divide configuration register)
+auto constexpr APIC_TIMER_DIVISOR = 16u;
+
+// tsc and apic timer frequencies enumerated by cpuid
+// returns zeroed values when not reported
+auto inline clock_from_cpuid() -> Clock {
+    // hypervisor timing leaf (vmware convention, also provided by qemu/kvm)
+    // present when cpuid 1 ecx bit 31 (hypervisor) is set and the max
+    // hypervisor leaf includes it
+    if ((core::cpuid(1).ecx & (1u << 31)) &&
+        core::cpuid(0x4000'0000).eax >= 0x4000'0010) {
+        // eax: tsc frequency in khz
+        // ebx: apic bus frequency in khz
+        auto const t = core::cpuid(0x4000'0010);
+        if (t.eax != 0 && t.ebx != 0) {
+            serial::print("  clock: cpuid 0x40000010\n");
+            return {.tsc_ticks_per_sec = u64(t.eax) * 1'000,
+                    .apic_ticks_per_sec =
+                        u64(t.ebx) * 1'000 / APIC_TIMER_DIVISOR};
+        }
+    }
 
-// reads the 64-bit time stamp counter (tsc)
-auto inline read_tsc() -> u64 {
-    auto low = 0u;
-    auto high = 0u;
-    asm volatile("rdtsc" : "=a"(low), "=d"(high));
-    return (u64(high) << 32) | low;
+    auto const max_leaf = core::cpuid(0).eax;
+    if (max_leaf < 0x15) {
+        return {};
+    }
+
+    // eax: denominator of tsc / core crystal clock ratio
+    // ebx: numerator of tsc / core crystal clock ratio
+    // ecx: core crystal clock frequency in hz (0 if not enumerated)
+    auto const t = core::cpuid(0x15);
+    if (t.eax == 0 || t.ebx == 0) {
+        return {};
+    }
+
+    auto crystal_hz = u64(t.ecx);
+    if (crystal_hz == 0 && max_leaf >= 0x16) {
+        // derive crystal from processor base frequency (eax, mhz)
+        crystal_hz = u64(core::cpuid(0x16).eax) * 1'000'000 * t.eax / t.ebx;
+    }
+    if (crystal_hz == 0) {
+        return {};
+    }
+
+    // note: when leaf 0x15 enumerates the ratio the lapic timer is clocked by
+    //       the core crystal (intel sdm 10.5.4)
+    serial::print("  clock: cpuid 0x15\n");
+    return {.tsc_ticks_per_sec = crystal_hz * t.ebx / t.eax,
+            .apic_ticks_per_sec = crystal_hz / APIC_TIMER_DIVISOR};
 }
 
-// apic timer calibration
-auto inline calibrate_apic_and_tsc() -> void {
+// apic timer calibration against the hpet
+// note: busy-waits 10ms
+auto inline calibrate_with_hpet() -> void {
     // read period (femtoseconds per tick) from top 32 bits of capabilities
     auto const period_fs = hpet.address[0] >> 32;
 
@@ -394,7 +714,7 @@ auto inline calibrate_apic_and_tsc() -> void {
     apic.local[0x380 / 4] = 0xffff'ffff;
 
     // capture start values
-    auto const tsc_start = read_tsc();
+    auto const tsc_start = core::read_tsc();
     auto const hpet_start = hpet.address[0xf0 / 8];
 
     // poll hpet counter until 10ms has elapsed
@@ -403,19 +723,60 @@ auto inline calibrate_apic_and_tsc() -> void {
     }
 
     // capture end values
-    auto const tsc_end = read_tsc();
+    auto const tsc_end = core::read_tsc();
     auto const lapic_remaining = apic.local[0x390 / 4];
 
     // disable hpet
     hpet.address[0x10 / 8] &= ~1ull;
 
     // calculate frequencies using 10ms interval
-    apic_ticks_per_sec = (0xffff'ffff - lapic_remaining) * 100;
-    tsc_ticks_per_sec = (tsc_end - tsc_start) * 100;
+    clock.apic_ticks_per_sec = u64(0xffff'ffff - lapic_remaining) * 100;
+    clock.tsc_ticks_per_sec = (tsc_end - tsc_start) * 100;
+}
+
+// prints `label` and frequency in khz
+auto print_khz(char const* const label, u64 const hz) -> void {
+    serial::print(label);
+    serial::print_dec(hz / 1'000);
+    serial::print(" kHz\n");
+}
+
+// tsc and apic timer frequencies from cpuid when enumerated; hpet
+// calibration as fallback or, when configured, as validation
+auto inline calibrate_apic_and_tsc() -> void {
+    auto const enumerated = clock_from_cpuid();
+    auto const has_enumerated = enumerated.tsc_ticks_per_sec != 0;
+
+    if (has_enumerated && (!config::VALIDATE_CPUID_CLOCK || !hpet.address)) {
+        clock = enumerated;
+    } else if (hpet.address) {
+        serial::print("  clock: hpet\n");
+        calibrate_with_hpet();
+
+        if (has_enumerated) {
+            // validation: report measured values and use enumerated
+            print_khz("    hpet tsc: ", clock.tsc_ticks_per_sec);
+            print_khz("   hpet apic: ", clock.apic_ticks_per_sec);
+            clock = enumerated;
+        }
+    } else {
+        serial::print("abort: no cpuid frequencies and no hpet\n");
+        panic(0x00'ff'80'00); // orange
+    }
+
+    print_khz("    tsc: ", clock.tsc_ticks_per_sec);
+    print_khz("   apic: ", clock.apic_ticks_per_sec);
 }
 
 auto constexpr TIMER_VECTOR = 32u;
 
+// icr (initial count register): set the countdown start value for `hz`
+// interrupts per second; restarts the countdown
+// use calibration to determine value
+auto set_timer_frequency(u32 const hz) -> void {
+    apic.local[0x380 / 4] = u32(clock.apic_ticks_per_sec / hz);
+}
+
 // disables legacy pic and starts lapic timer in periodic mode
 auto inline init_timer() -> void {
     // disable legacy pic: mask all interrupts on master (0x21) and slave (0xa1)
@@ -429,6 +790,7 @@ auto inline init_timer() -> void {
 
     // dcr (divide configuration register): set timer divisor
     // 0x03: divide by 16 (timer decrements every 16 bus cycles)
+    // note: matches `APIC_TIMER_DIVISOR`
     apic.local[0x3e0 / 4] = 3;
 
     // lvt timer register: configure mode and vector
@@ -438,9 +800,7 @@ auto inline init_timer() -> void {
 
     calibrate_apic_and_tsc();
 
-    // icr (initial count register): set the countdown start value
-    // use calibration to determine value
-    apic.local[0x380 / 4] = apic_ticks_per_sec / config::TIMER_FREQUENCY_HZ;
+    set_timer_frequency(config::TIMER_FREQUENCY_HZ);
 }
 
 // io-apic register access
@@ -454,12 +814,136 @@ auto io_apic_write(u32 const reg, u32 const val) -> void {
 }
 
 auto constexpr KEYBOARD_VECTOR = 33u;
+auto constexpr IPI_VECTOR = 34u;
+
+// keyboard enable handshake state
+// note: only accessed from bsp in init, `keyboard_poll` while interrupts are
+//       disabled and interrupt handlers which do not nest
+struct KeyboardEnable {
+    // first enable command issued
+    bool started;
+    bool ready;
+    // timer back to the minimal tier; nothing left to do
+    bool done;
+    // enable commands sent
+    u32 attempts;
+    // sends put off because the controller was busy
+    u32 deferred;
+    u32 timer_interrupts;
+    u64 sent_tsc;
+};
+
+KeyboardEnable keyboard_enable;
+
+// resends per keyboard enable before giving up
+auto constexpr KEYBOARD_ENABLE_MAX_ATTEMPTS = 8u;
+
+// busy controller retries per keyboard enable before giving up; 1s
+auto constexpr KEYBOARD_ENABLE_MAX_DEFERRED = 100u;
+
+// timer frequency while the enable is pending so retries follow the 100ms
+// answer timeout instead of the timer tick; 8 attempts take about 800ms
+auto constexpr KEYBOARD_RETRY_HZ = 100u;
+
+static_assert(KEYBOARD_RETRY_HZ % config::TIMER_FREQUENCY_HZ == 0,
+              "ticks are counted every n-th interrupt while retrying");
+
+// sends command 0xf4 (enable scanning) if the controller accepts input
+// tells the keyboard to start sending scancodes when keys are pressed
+// note: when the controller is busy the next timer interrupt retries; only
+//       sent commands count as attempts
+auto keyboard_send_enable() -> void {
+    keyboard_enable.started = true;
+
+    // controller: check bit 1 (input buffer full)
+    // cannot send commands until this bit is 0
+    if (inb(0x64) & 2) {
+        ++keyboard_enable.deferred;
+        return;
+    }
+
+    ++keyboard_enable.attempts;
+    keyboard_enable.sent_tsc = core::read_tsc();
+    outb(0x60, 0xf4);
+}
+
+// handles a byte from the keyboard while enable is pending
+// returns true if the byte was part of the handshake
+auto keyboard_on_enable_response(u8 const response) -> bool {
+    if (response == 0xfa) {
+        // acknowledge
+        // note: printed by `print_boot_timeline` or logged by osca; not from
+        //       here where it would interleave with the bsp's output
+        keyboard_enable.ready = true;
+        boot::timeline.keyboard_attempts = keyboard_enable.attempts;
+        boot::timeline.keyboard_ready_tsc = core::read_tsc();
+        return true;
+    }
+
+    if (response == 0xfe) {
+        // resend requested
+        if (keyboard_enable.attempts < KEYBOARD_ENABLE_MAX_ATTEMPTS) {
+            keyboard_send_enable();
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// called from timer; resends enable if no ack arrived
+// note: once the handshake is over the timer moves to the minimal tier and
+//       back to `config::TIMER_FREQUENCY_HZ`
+auto keyboard_on_timer() -> void {
+    // give the keyboard 100ms to answer
+    // note: a deferred send leaves `sent_tsc` so it is retried right away
+    auto const elapsed = core::read_tsc() - keyboard_enable.sent_tsc;
+    auto const waiting = elapsed < clock.tsc_ticks_per_sec / 10;
+
+    if (!keyboard_enable.ready) {
+        if (keyboard_enable.deferred < KEYBOARD_ENABLE_MAX_DEFERRED &&
+            keyboard_enable.attempts < KEYBOARD_ENABLE_MAX_ATTEMPTS) {
+            if (!waiting) {
+                keyboard_send_enable();
+            }
+            return;
+        }
+        if (waiting) {
+            // last attempt may still be acknowledged
+            return;
+        }
+        boot::timeline.keyboard_attempts = keyboard_enable.attempts;
+        boot::timeline.keyboard_failed = 1;
+    }
+
+    keyboard_enable.done = true;
+    set_timer_frequency(config::TIMER_FREQUENCY_HZ);
+    register_interrupt(TIMER_VECTOR, IsrTier::MINIMAL, kernel_on_timer);
+}
+
+// runs the handshake by polling while interrupts are still disabled during
+// boot; called between boot phases
+// note: keys pressed before the acknowledge are dropped
+auto keyboard_poll() -> void {
+    if (!keyboard_enable.started || keyboard_enable.done) {
+        return;
+    }
+
+    // controller: check bit 0 (output buffer full)
+    while (!keyboard_enable.ready && (inb(0x64) & 1)) {
+        keyboard_on_enable_response(inb(0x60));
+    }
+
+    // retries like the timer would, or leaves the retry tier once done
+    keyboard_on_timer();
+}
 
 // keyboard and io-apic routing
-// routes keyboard irq through io-apic and enables scanning
+// routes keyboard irq through io-apic and requests scanning without waiting for
+// the acknowledge
 auto inline init_keyboard() -> void {
     // get local apic id of the current cpu (bits 24-31 of offset 0x020)
-    auto const cpu_id = (apic.local[0x020 / 4] >> 24) & 0xff;
+    auto const cpu_id = u32(core::apic_id());
 
     // configure io-apic redirection table for keyboard (usually gsi 1)
     // index 0x10 is the start of the redirection table with 2 x 32-bit
@@ -477,28 +961,10 @@ auto inline init_keyboard() -> void {
         inb(0x60);
     }
 
-    // wait for controller: check bit 1 (input buffer full)
-    // cannot send commands until this bit is 0
-    while (inb(0x64) & 2) {
-        core::pause();
-    }
-
-    // send command 0xf4: enable scanning
-    // tells the keyboard to start sending scancodes when keys are pressed
-    outb(0x60, 0xf4);
-
-    // diagnostic: wait for 0xfa (acknowledge) from the keyboard
-    // assuming hardware is correct, we block indefinitely until ack
-    while (true) {
-        if (inb(0x64) & 1) {
-            auto const response = inb(0x60);
-            if (response == 0xfa) {
-                serial::print("  ack\n");
-                break;
-            }
-        }
-        core::pause();
-    }
+    // boot continues; ack is handled by `on_keyboard_interrupt` and retries by
+    // `on_timer_interrupt_during_keyboard_enable`
+    keyboard_send_enable();
+    set_timer_frequency(KEYBOARD_RETRY_HZ);
 }
 
 // 16-byte descriptor format for x86-64
@@ -518,50 +984,27 @@ struct [[gnu::packed]] IDTR {
     u64 base;
 };
 
-// idt (interrupt descriptor table) init for bootstrap processor
-auto inline init_idt_bsp() -> void {
-    // alignas(16): required for performance and hardware consistency
-    alignas(16) static IDTEntry idt[256];
+// idt (interrupt descriptor table) shared by all cores
+// alignas(16): required for performance and hardware consistency
+alignas(16) IDTEntry idt[256];
 
-    // set idt entry lapic timer
-    // 0x8e: 10001110b -> p=1, dpl=00, type=1110 (64-bit interrupt gate)
-    // p : present
-    // dpl: ring 0
-    // type: 64-bit interrupt gate (clears IF on entry, preventing nesting)
-    // selector 0x08: second entry in the gdt, 64-bit code descriptor
-    auto const apic_addr = u64(kernel_asm_timer_handler);
-    idt[TIMER_VECTOR] = {u16(apic_addr),       8, 0, 0x8e, u16(apic_addr >> 16),
-                         u32(apic_addr >> 32), 0};
-
-    // set idt entry keyboard
-    auto const kbd_addr = u64(kernel_asm_keyboard_handler);
-    idt[KEYBOARD_VECTOR] = {
-        u16(kbd_addr), 8, 0, 0x8e, u16(kbd_addr >> 16), u32(kbd_addr >> 32), 0};
-
-    auto const idtr = IDTR{sizeof(idt) - 1, u64(idt)};
-
-    // lidt: load the interrupt descriptor table register
-    asm volatile("lidt %0" : : "m"(idtr));
-}
-
-// idt (interrupt descriptor table) init for application processor
-auto inline init_idt_ap() -> void {
-    alignas(16) static IDTEntry idt[256];
-    // empty idt: any interrupt will cause triple fault and reset
-
-    auto const idtr = IDTR{sizeof(idt) - 1, u64(idt)};
-    asm volatile("lidt %0" : : "m"(idtr));
-}
+// vectors of the empty handlers used by `interrupt_self`
+auto constexpr PROBE_MINIMAL_VECTOR = 35u;
+auto constexpr PROBE_FULL_VECTOR = 36u;
 
 // keyboard interrupt handler
-// c-linkage handler called by assembly isr stub
-extern "C" auto kernel_on_keyboard() -> void {
+auto on_keyboard_interrupt() -> void {
     // drain ps/2 output buffer: bit 0 of status (0x64) means data is waiting
     // reading all pending bytes prevents the controller from getting "stuck"
     while (inb(0x64) & 1) {
         // read raw byte from data port
         auto const scancode = inb(0x60);
 
+        // ack or resend of pending enable is not a key event
+        if (!keyboard_enable.ready && keyboard_on_enable_response(scancode)) {
+            continue;
+        }
+
         // log scancode to serial for debugging
         serial::print("|");
         serial::print_hex_byte(scancode);
@@ -577,18 +1020,63 @@ extern "C" auto kernel_on_keyboard() -> void {
     apic.local[0x0b0 / 4] = 0;
 }
 
-// lapic timer interrupt handler
-// c-linkage handler called by the assembly timer stub
-extern "C" auto kernel_on_timer() -> void {
-    // notify the os layer that a tick has occurred
-    osca::on_timer();
+// lapic timer interrupt handler while the keyboard enable is pending
+// note: full tier; replaced by the minimal `kernel_on_timer` once the
+//       handshake is over
+auto on_timer_interrupt_during_keyboard_enable() -> void {
+    keyboard_on_timer();
+
+    // `ticks` keep counting at `config::TIMER_FREQUENCY_HZ`
+    ++keyboard_enable.timer_interrupts;
+    if (keyboard_enable.timer_interrupts %
+            (KEYBOARD_RETRY_HZ / config::TIMER_FREQUENCY_HZ) ==
+        0) {
+        kernel_on_timer();
+        return;
+    }
+
+    // write any value (conventionally 0) to EOI register
+    apic.local[0x0b0 / 4] = 0;
+}
+
+// inter-processor interrupt handler
+auto on_ipi_interrupt() -> void {
+    osca::on_ipi();
 
     // write any value (conventionally 0) to EOI register
-    // notifies the lapic that the handler is finished so it can deliver the
-    // next interrupt
     apic.local[0x0b0 / 4] = 0;
 }
 
+auto inline load_idt() -> void {
+    auto const idtr = IDTR{sizeof(idt) - 1, u64(idt)};
+
+    // lidt: load the interrupt descriptor table register
+    asm volatile("lidt %0" : : "m"(idtr));
+}
+
+// idt init for bootstrap processor; registers the handlers of all cores
+auto inline init_idt_bsp() -> void {
+    register_interrupt(TIMER_VECTOR, IsrTier::FULL,
+                       on_timer_interrupt_during_keyboard_enable);
+    register_interrupt(KEYBOARD_VECTOR, IsrTier::FULL, on_keyboard_interrupt);
+    register_interrupt(IPI_VECTOR, IsrTier::FULL, on_ipi_interrupt);
+    register_interrupt(PROBE_MINIMAL_VECTOR, IsrTier::MINIMAL,
+                       kernel_on_probe);
+    register_interrupt(PROBE_FULL_VECTOR, IsrTier::FULL, kernel_on_probe);
+
+    load_idt();
+}
+
+// idt init for application processor
+// note: timer and keyboard interrupts are routed to the bsp only
+auto inline init_idt_ap() -> void {
+    load_idt();
+
+    // svr (spurious interrupt vector register): software enable lapic so the
+    // core accepts ipis
+    apic.local[0x0f0 / 4] = 0x1ff;
+}
+
 // jumping to the os entry point
 [[noreturn]] auto osca_start() -> void {
     // pivot: load the new stack pointer (rsp) and base pointer (rbp)
@@ -597,104 +1085,175 @@ extern "C" auto kernel_on_timer() -> void {
                  "mov %0, %%rbp\n\t"
                  "jmp *%1"
                  :
-                 : "r"(&kernel_stack[sizeof(kernel_stack)] - 8),
+                 : "r"(&kernel_stack[sizeof(kernel_stack)] - 8 - 32),
                    "r"(osca::start)
                  : "memory");
     // note: why -8?
     // the x86-64 system v abi requires the stack to be 16-byte aligned at the
     // point a call occurs; since a call pushes an 8-byte return address, the
     // compiler expects the stack to end in 0x8 upon entering a function.
+    // note: why -32?
+    // the ms x64 abi lets the callee use 32 bytes of shadow space above its
+    // return address
 
     // the compiler is informed that this point is never reached
     __builtin_unreachable();
 }
 
-// sequential ap startup; flag reused per core bring-up
-auto run_core_started_flag = false;
+// number of application processors that reached `run_core`
+auto cores_started = 0u;
+
+// tsc when the bsp started the init-sipi-sipi sequence; used by application
+// processors to record their bring-up duration
+auto cores_start_tsc = 0ull;
 
 // this is the entry point for application processors
 // each core lands here after the trampoline finishes
-[[noreturn]] auto run_core() -> void {
-    // flag bsp that core is running
-    // (1) paired with acquire (2)
-    atomic::store(&run_core_started_flag, true, atomic::RELEASE);
-
+// `core_index` is the ticket the core took in the trampoline
+// note: the trampoline passes the ticket in rcx (ms x64 abi)
+[[noreturn]] auto run_core(u32 const core_index) -> void {
     init_fpu();
     init_gdt();
     init_idt_ap();
 
-    // find this core index
-    auto const apic_id = (apic.local[0x020 / 4] >> 24) & 0xff;
-    for (auto i = 0u; i < core_count; ++i) {
-        if (cores[i].apic_id == apic_id) {
-            osca::run_core(i);
-        }
-    }
+    // claim the slot given by the ticket
+    auto const apic_id = core::apic_id();
+    cores[core_index] = {.apic_id = apic_id,
+                         .index = core_index,
+                         .node = numa.apic_node[apic_id]};
+    core::set_index(core_index);
+    boot::timeline.core_start_ticks[core_index] =
+        core::read_tsc() - atomic::load(&cores_start_tsc, atomic::RELAXED);
 
-    // core not found
-    serial::print("error: core not found\n");
-    panic(0x00'ff'ff'ff); // white
+    // flag bsp that core is running
+    // (1) paired with acquire (2)
+    atomic::add(&cores_started, 1u, atomic::RELEASE);
+
+    // accept ipis from here on
+    core::interrupts_enable();
+    osca::run_core(core_index);
 }
 
 auto delay_us(u64 const us) -> void {
-    auto const target = read_tsc() + (tsc_ticks_per_sec * us / 1'000'000);
-    while (read_tsc() < target) {
+    auto const target =
+        core::read_tsc() + (clock.tsc_ticks_per_sec * us / 1'000'000);
+    while (core::read_tsc() < target) {
         core::pause();
     }
 }
 
-auto inline send_init_sipi(u8 const apic_id, u32 const trampoline_address)
-    -> void {
-
+// writes the interrupt command register and waits for delivery
+auto inline send_icr(u8 const apic_id, u32 const command) -> void {
     // select target core via high dword of icr
     apic.local[0x310 / 4] = u32(apic_id) << 24;
 
-    // send init ipi to reset the application processor (ap)
-    apic.local[0x300 / 4] = 0x00004500;
+    // writing the low dword sends the ipi
+    apic.local[0x300 / 4] = command;
 
     // wait until the delivery status bit clears
     while (apic.local[0x300 / 4] & (1 << 12)) {
         core::pause();
     }
+}
 
-    // wait 10ms for ap to settle after reset (intel requirement)
-    delay_us(10 * 1'000);
+// init ipi resets the application processor (ap)
+auto inline send_init(u8 const apic_id) -> void {
+    send_icr(apic_id, 0x00004500);
+}
 
+// startup ipi wakes the ap at the page given by `trampoline_address`
+auto inline send_sipi(u8 const apic_id, u32 const trampoline_address)
+    -> void {
     // convert address to 4KB page vector; 0x8000 -> 0x08
     auto const vector = trampoline_address >> 12;
 
-    // re-select target apic id
-    apic.local[0x310 / 4] = u32(apic_id) << 24;
+    send_icr(apic_id, 0x00004600 | vector);
+}
 
-    // send first sipi to wake ap at vector address
-    apic.local[0x300 / 4] = 0x00004600 | vector;
+// addresses in the assembler code
+extern "C" u8 kernel_asm_run_core_start[];
+extern "C" u8 kernel_asm_run_core_end[];
+extern "C" u8 kernel_asm_run_core_config[];
 
-    // wait for delivery check
-    while (apic.local[0x300 / 4] & (1 << 12)) {
-        core::pause();
+auto constexpr TRAMPOLINE_DEST = uptr(0x8000);
+
+// top of stack for each apic id; read by the trampoline using the initial apic
+// id from cpuid
+// note: indexed by apic id because tickets are taken in arrival order and the
+//       stack must be on the core's numa node
+uptr core_stacks[256];
+
+// apic ids of the cores to start, copied before the first sipi
+// note: a started ap overwrites `cores[ticket]` with its own apic id while
+//       the bsp still sends sipis to the others
+u8 core_apic_ids[256];
+
+auto inline copy_core_apic_ids() -> void {
+    for (auto i = 0u; i < core_count; ++i) {
+        core_apic_ids[i] = cores[i].apic_id;
+    }
+}
+
+// starts all application processors at once: init to every ap, one 10ms
+// settle, then two rounds of sipi
+auto inline start_cores_parallel() -> void {
+    copy_core_apic_ids();
+
+    for (auto i = 1u; i < core_count; ++i) {
+        send_init(core_apic_ids[i]);
+    }
+
+    // wait 10ms for aps to settle after reset (intel requirement)
+    delay_us(10 * 1'000);
+
+    for (auto i = 1u; i < core_count; ++i) {
+        send_sipi(core_apic_ids[i], TRAMPOLINE_DEST);
     }
 
     // 200us delay before retry (intel requirement)
     delay_us(200);
 
-    // re-select target apic id (intel requirement)
-    apic.local[0x310 / 4] = u32(apic_id) << 24;
-
-    // send second sipi (intel requirement)
-    apic.local[0x300 / 4] = 0x00004600 | vector;
+    // second sipi (intel requirement)
+    // note: ignored by aps that already started
+    for (auto i = 1u; i < core_count; ++i) {
+        send_sipi(core_apic_ids[i], TRAMPOLINE_DEST);
+    }
 
-    // final delivery check
-    while (apic.local[0x300 / 4] & (1 << 12)) {
+    // wait for all cores to start
+    // (2) paired with release (1)
+    while (atomic::load(&cores_started, atomic::ACQUIRE) != core_count - 1u) {
         core::pause();
     }
 }
 
-// addresses in the assembler code
-extern "C" u8 kernel_asm_run_core_start[];
-extern "C" u8 kernel_asm_run_core_end[];
-extern "C" u8 kernel_asm_run_core_config[];
+// starts application processors one at a time
+// note: reference path for measuring parallel bring-up
+auto inline start_cores_sequential() -> void {
+    copy_core_apic_ids();
 
-auto constexpr TRAMPOLINE_DEST = uptr(0x8000);
+    for (auto i = 1u; i < core_count; ++i) {
+        atomic::store(&cores_start_tsc, core::read_tsc(), atomic::RELAXED);
+
+        send_init(core_apic_ids[i]);
+
+        // wait 10ms for ap to settle after reset (intel requirement)
+        delay_us(10 * 1'000);
+
+        send_sipi(core_apic_ids[i], TRAMPOLINE_DEST);
+
+        // 200us delay before retry (intel requirement)
+        delay_us(200);
+
+        // second sipi (intel requirement)
+        send_sipi(core_apic_ids[i], TRAMPOLINE_DEST);
+
+        // wait for core to start
+        // (2) paired with release (1)
+        while (atomic::load(&cores_started, atomic::ACQUIRE) != i) {
+            core::pause();
+        }
+    }
+}
 
 auto inline init_cores() -> void {
 
@@ -735,47 +1294,138 @@ auto inline init_cores() -> void {
     // calculate the offset of the config data relative to the start
     auto const config_offset = uptr(kernel_asm_run_core_config) - start_addr;
 
-    auto const bsp_id = apic.local[0x020 / 4] >> 24;
+    // allocate a unique stack for each core on its numa node
+    for (auto i = 1u; i < core_count; ++i) {
+        auto const apic_id = cores[i].apic_id;
+        auto const stack = allocate_pages(config::CORE_STACK_SIZE_PAGES,
+                                          numa.apic_node[apic_id]);
+        core_stacks[apic_id] =
+            uptr(stack) + config::CORE_STACK_SIZE_PAGES * PAGE_4K;
+    }
 
-    for (auto i = 0u; i < core_count; ++i) {
-        // skip the bsp (the core currently running this code)
-        // usually the bsp has apic id 0, but check specifically
-        if (cores[i].apic_id == bsp_id) {
-            continue;
-        }
+    // define struct
+    struct [[gnu::packed]] TrampolineConfig {
+        uptr protected_mode_pdpt;
+        uptr stacks;
+        uptr task;
+        uptr long_mode_pml4;
+        u32 ticket;
+        u32 unused;
+    };
+    auto* const config =
+        ptr_offset<TrampolineConfig>(TRAMPOLINE_DEST, config_offset);
+
+    // fill the values
+    config->protected_mode_pdpt = uptr(protected_mode_pdpt);
+    config->stacks = uptr(core_stacks);
+    config->task = uptr(run_core);
+    config->long_mode_pml4 = uptr(long_mode_pml4);
+    // first ticket after the bsp
+    config->ticket = 1;
+
+    atomic::store(&cores_start_tsc, core::read_tsc(), atomic::RELAXED);
+
+    if constexpr (config::PARALLEL_CORE_START) {
+        start_cores_parallel();
+    } else {
+        start_cores_sequential();
+    }
+}
 
-        // allocate a unique stack for this specific core
-        auto const stack = allocate_pages(config::CORE_STACK_SIZE_PAGES);
-        auto const stack_top =
-            uptr(stack) + config::CORE_STACK_SIZE_PAGES * PAGE_4K;
+// marks the start of a boot phase and prints its name
+// note: also polls the keyboard handshake; interrupts are disabled until
+//       `osca_start`
+auto inline begin_phase(char const* const name) -> void {
+    keyboard_poll();
+    boot::mark(name);
+    serial::print(name);
+    serial::print("\n");
+}
 
-        // define struct
-        struct [[gnu::packed]] TrampolineConfig {
-            uptr protected_mode_pdpt;
-            uptr stack;
-            uptr task;
-            uptr long_mode_pml4;
-        };
-        auto* const config =
-            ptr_offset<TrampolineConfig>(TRAMPOLINE_DEST, config_offset);
+// prints `s` left aligned in `width` columns
+auto print_padded(char const* const s, u32 const width) -> void {
+    serial::print(s);
+    auto len = 0u;
+    while (s[len]) {
+        ++len;
+    }
+    for (auto i = len; i < width; ++i) {
+        serial::print(" ");
+    }
+}
 
-        // fill the values
-        config->protected_mode_pdpt = uptr(protected_mode_pdpt);
-        config->stack = uptr(stack_top);
-        config->task = uptr(run_core);
-        config->long_mode_pml4 = uptr(long_mode_pml4);
+// prints `val` right aligned in `width` columns
+auto print_dec_padded(u64 const val, u32 const width) -> void {
+    auto digits = 1u;
+    for (auto v = val; v >= 10; v /= 10) {
+        ++digits;
+    }
+    for (auto i = digits; i < width; ++i) {
+        serial::print(" ");
+    }
+    serial::print_dec(val);
+}
 
-        // relaxed: flag is polled only after sipi, no prior data depends on it
-        atomic::store(&run_core_started_flag, false, atomic::RELAXED);
+// prints phase durations and share of total boot time
+// note: the last marked phase is the end of the timeline; requires calibrated
+//       tsc
+auto print_boot_timeline() -> void {
+    auto const& tl = boot::timeline;
+    auto const first = tl.phases[0].tsc;
+    auto const last = tl.phases[tl.phase_count - 1].tsc;
+    auto const total = last - first;
+
+    serial::print("boot timeline:\n");
+    serial::print("  phase                         us  share\n");
+    for (auto i = 0u; i + 1 < tl.phase_count; ++i) {
+        auto const ticks = tl.phases[i + 1].tsc - tl.phases[i].tsc;
+
+        serial::print("  ");
+        print_padded(tl.phases[i].name, 20);
+        print_dec_padded(core::tsc_to_ns(ticks) / 1'000, 12);
+
+        // share in tenths of a percent
+        auto const permille = total ? ticks * 1'000 / total : 0;
+        print_dec_padded(permille / 10, 5);
+        serial::print(".");
+        serial::print_dec(permille % 10);
+        serial::print("%\n");
+    }
 
-        // send the init-sipi-sipi sequence via the apic to start the core
-        send_init_sipi(cores[i].apic_id, TRAMPOLINE_DEST);
+    serial::print("  total               ");
+    print_dec_padded(core::tsc_to_ns(total) / 1'000, 12);
+    serial::print("\n");
 
-        // wait for core to start
-        // (2) paired with release (1)
-        while (!atomic::load(&run_core_started_flag, atomic::ACQUIRE)) {
-            core::pause();
-        }
+    // tsc counts from reset; approximates firmware time before `efi_main`
+    serial::print("  before efi_main     ");
+    print_dec_padded(core::tsc_to_ns(first) / 1'000, 12);
+    serial::print("\n");
+
+    // since `efi_main`; seen at the first phase boundary after the acknowledge
+    serial::print("  keyboard ready      ");
+    if (tl.keyboard_ready_tsc) {
+        print_dec_padded(core::tsc_to_ns(tl.keyboard_ready_tsc - first) / 1'000,
+                         12);
+        serial::print("  attempts: ");
+        serial::print_dec(tl.keyboard_attempts);
+    } else if (tl.keyboard_failed) {
+        serial::print("      failed  attempts: ");
+        serial::print_dec(tl.keyboard_attempts);
+    } else {
+        serial::print("     pending");
+    }
+    serial::print("\n");
+
+    // application processors; the bsp is core 0
+    for (auto i = 1u; i < core_count; ++i) {
+        auto const ticks = tl.core_start_ticks[i];
+        serial::print("  core ");
+        print_dec_padded(i, 3);
+        serial::print(" apic ");
+        print_dec_padded(cores[i].apic_id, 3);
+        serial::print("  ");
+        print_dec_padded(core::tsc_to_ns(ticks) / 1'000, 12);
+        serial::print("\n");
     }
 }
 
@@ -783,54 +1433,132 @@ auto inline init_cores() -> void {
 
 namespace kernel {
 
-// bump allocator returning zeroed 4KB pages
-auto allocate_pages(u64 const num_pages) -> void* {
-    auto const bytes = num_pages * PAGE_4K;
+auto register_interrupt(u8 const vector, IsrTier const tier,
+                        IsrHandler const handler) -> void {
+    if (vector < ISR_FIRST_VECTOR ||
+        vector >= ISR_FIRST_VECTOR + ISR_VECTOR_COUNT) {
+        serial::print("error: no interrupt stub for vector\n");
+        panic(0x00'ff'00'ff); // magenta
+    }
+
+    // handler before gate; a pending interrupt finds it set
+    kernel_isr_handlers[vector] = handler;
 
-    // ensure heap has enough space for the requested allocation
-    if (heap.size < bytes) {
+    auto const stub = tier == IsrTier::MINIMAL
+                          ? kernel_asm_isr_minimal_stubs[vector -
+                                                         ISR_FIRST_VECTOR]
+                          : kernel_asm_isr_full_stubs[vector - ISR_FIRST_VECTOR];
+
+    // 0x8e: 10001110b -> p=1, dpl=00, type=1110 (64-bit interrupt gate)
+    // p : present
+    // dpl: ring 0
+    // type: 64-bit interrupt gate (clears IF on entry, preventing nesting)
+    // selector 0x08: second entry in the gdt, 64-bit code descriptor
+    idt[vector] = {u16(stub), 8, 0, 0x8e, u16(stub >> 16), u32(stub >> 32), 0};
+}
+
+auto interrupt_self(IsrTier const tier) -> void {
+    auto const vector =
+        tier == IsrTier::MINIMAL ? PROBE_MINIMAL_VECTOR : PROBE_FULL_VECTOR;
+    auto const handled = atomic::load(&probes, atomic::RELAXED);
+
+    send_icr(core::apic_id(), 0x00004000 | vector);
+
+    while (atomic::load(&probes, atomic::RELAXED) == handled) {
+        core::pause();
+    }
+}
+
+auto send_ipi(u8 const apic_id) -> void {
+    // fixed delivery, physical destination, level assert
+    send_icr(apic_id, 0x00004000 | IPI_VECTOR);
+}
+
+// allocates zeroed 4KB pages
+// note: pre-zeroed blocks skip the memset
+auto allocate_pages(u64 const num_pages, u32 const node) -> void* {
+    auto const block = memory::pages.allocate(num_pages, true, node);
+
+    if (!block.address) {
         serial::print("error: out of memory when allocating pages\n");
         panic(0x00'ff'00'00); // red
     }
 
-    auto* const p = heap.start;
-    heap.start = ptr_offset<void>(heap.start, bytes);
-    heap.size -= bytes;
-    memset(p, 0, bytes);
+    if (!block.clean) {
+        memset(block.address, 0, num_pages * PAGE_4K);
+    }
+    memory::pages.count_zeroed(num_pages * PAGE_4K, block.clean);
+    return block.address;
+}
+
+auto allocate_pages_uninit(u64 const num_pages, u32 const node) -> void* {
+    auto* const p = memory::pages.allocate(num_pages, false, node).address;
+
+    if (!p) {
+        serial::print("error: out of memory when allocating pages\n");
+        panic(0x00'ff'00'00); // red
+    }
+
+    return p;
+}
+
+auto free_pages(void* const p, u64 const num_pages) -> void {
+    memory::pages.free(p, num_pages);
+}
+
+auto zero_free_pages() -> bool { return memory::pages.zero_idle(); }
+
+auto kmalloc(u64 const size) -> void* {
+    auto* const p = memory::slabs.allocate(size);
+
+    if (!p) {
+        serial::print("error: out of memory in kmalloc\n");
+        panic(0x00'ff'00'00); // red
+    }
+
     return p;
 }
 
+auto kfree(void* const p) -> void { memory::slabs.free(p); }
+
 } // namespace kernel
 
 [[noreturn]] auto kernel::start() -> void {
+    boot::mark("init_serial");
     init_serial();
     serial::print("serial initiated\n");
 
-    serial::print("init_fpu\n");
+    begin_phase("init_fpu");
+    init_xsave();
     init_fpu();
 
-    serial::print("init_gdt\n");
+    begin_phase("init_gdt");
     init_gdt();
 
-    serial::print("init_heap\n");
+    begin_phase("init_bsp");
+    init_bsp();
+
+    begin_phase("init_heap");
     init_heap();
 
-    serial::print("init_paging\n");
+    begin_phase("init_paging");
     init_paging();
+    add_boot_services_memory();
 
-    serial::print("init_idt_bsp\n");
+    begin_phase("init_idt_bsp");
     init_idt_bsp();
 
-    serial::print("init_timer\n");
+    begin_phase("init_timer");
     init_timer();
 
-    serial::print("init_keyboard\n");
+    begin_phase("init_keyboard");
     init_keyboard();
 
-    serial::print("init_cores\n");
+    begin_phase("init_cores");
     init_cores();
 
-    serial::print("osca_start\n");
+    begin_phase("osca_start");
+    print_boot_timeline();
     osca_start();
 }
 
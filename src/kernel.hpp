@@ -42,31 +42,157 @@ struct Hpet {
 
 Hpet inline hpet;
 
+// calibrated frequencies; valid after `init_timer`
+struct Clock {
+    u64 tsc_ticks_per_sec;
+    u64 apic_ticks_per_sec;
+};
+
+Clock inline clock;
+
+// extended state enabled on all cores; valid after `init_fpu`
+struct Fpu {
+    u64 xcr0;
+    u64 save_bytes; // interrupt entry save area
+    bool avx2;      // cpuid avx2
+    bool avx512;    // opmask and zmm state enabled
+};
+
+Fpu inline fpu;
+
+// identity map statistics; valid after `init_paging`
+struct Paging {
+    bool uses_1g_pages; // cpuid pdpe1gb and `config::USE_1G_PAGES`
+    u64 table_pages;    // 4KB page table pages allocated
+    u64 pages_1g;
+    u64 pages_2m;
+    u64 pages_4k;
+};
+
+Paging inline paging;
+
+auto constexpr MAX_NUMA_NODES = 8u;
+auto constexpr MAX_NUMA_RANGES = 64u;
+
+// physical memory `[start, end)` on `node`
+struct NumaRange {
+    uptr start;
+    uptr end;
+    u32 node;
+};
+
+// numa topology from acpi srat and slit; valid after `efi_main`
+// note: without srat there is one node holding all cores and memory
+struct Numa {
+    u32 node_count;
+    u32 range_count;
+    NumaRange ranges[MAX_NUMA_RANGES];
+    // node by apic id
+    u8 apic_node[256];
+    // slit distances; 10 is local
+    u8 distance[MAX_NUMA_NODES][MAX_NUMA_NODES];
+    // nodes by distance from each node, nearest (itself) first
+    u8 order[MAX_NUMA_NODES][MAX_NUMA_NODES];
+};
+
+Numa inline numa;
+
+// node of physical `address`; 0 if not in srat
+auto inline node_of(uptr const address) -> u32 {
+    for (auto i = 0u; i < numa.range_count; ++i) {
+        auto const& r = numa.ranges[i];
+        if (address >= r.start && address < r.end) {
+            return r.node;
+        }
+    }
+    return 0;
+}
+
+// node hint for allocations: the calling core's node
+auto constexpr NODE_LOCAL = ~0u;
+
 struct Core {
     u8 apic_id;
+    // index in `cores`; read through gs by `core::index()`
+    u32 index;
+    // numa node; read by `core::node()`
+    u32 node;
 };
 
 Core inline cores[256];
 u8 inline core_count;
 
-struct Heap {
-    void* start;
-    u64 size;
-};
-
-Heap inline heap;
-
 auto inline outb(u16 const port, u8 const val) -> void {
     asm volatile("outb %0, %1" : : "a"(val), "Nd"(port));
 }
 
+auto inline outl(u16 const port, u32 const val) -> void {
+    asm volatile("outl %0, %1" : : "a"(val), "Nd"(port));
+}
+
 auto inline inb(u16 const port) -> u8 {
     u8 result;
     asm volatile("inb %1, %0" : "=a"(result) : "Nd"(port));
     return result;
 }
 
-auto allocate_pages(u64 num_pages) -> void*;
+// allocates zeroed contiguous 4KB pages on `node`, falling back to the
+// nearest node with free memory
+// note: safe from any core; not from interrupt handlers
+auto allocate_pages(u64 num_pages, u32 node = NODE_LOCAL) -> void*;
+
+// allocates contiguous 4KB pages with undefined content
+// note: for callers overwriting all of it; keeps pre-zeroed pages for others
+auto allocate_pages_uninit(u64 num_pages, u32 node = NODE_LOCAL) -> void*;
+
+// frees pages from `allocate_pages` or `allocate_pages_uninit`; any page run
+// within an allocation
+auto free_pages(void* p, u64 num_pages) -> void;
+
+// zeroes a dirty free block ahead of time when the pre-zeroed pool is low
+// returns false if there was nothing to do
+// note: called by idle cores
+auto zero_free_pages() -> bool;
+
+// allocates `size` bytes from size class slabs; not zeroed
+// note: safe from any core; not from interrupt handlers
+auto kmalloc(u64 size) -> void*;
+
+// frees memory from `kmalloc` on any core; nullptr is ignored
+auto kfree(void* p) -> void;
+
+// interrupt entry and exit cost of a handler
+//  * minimal: saves caller-saved general purpose registers only; the handler
+//    and everything it calls must be compiled with `-mgeneral-regs-only`
+//  * full: saves all general purpose registers and the extended state; the
+//    handler may use simd
+enum class IsrTier : u8 { MINIMAL, FULL };
+
+using IsrHandler = auto (*)() -> void;
+
+// vectors available to `register_interrupt`
+auto constexpr ISR_FIRST_VECTOR = 32u;
+auto constexpr ISR_VECTOR_COUNT = 16u;
+
+// routes `vector` on all cores to `handler` through the stub of `tier`
+// note: the handler writes eoi; re-registering a vector is safe on the core
+//       receiving it with interrupts disabled
+auto register_interrupt(u8 vector, IsrTier tier, IsrHandler handler) -> void;
+
+// interrupts the calling core through an empty handler of `tier` and returns
+// once it ran
+// note: for measuring interrupt cost; interrupts must be enabled
+auto interrupt_self(IsrTier tier) -> void;
+
+// lapic timer ticks on the bsp at `config::TIMER_FREQUENCY_HZ`
+u64 inline ticks;
+
+// handled `interrupt_self` probes
+u64 inline probes;
+
+// sends an inter-processor interrupt to the core with `apic_id`
+// note: handled by `osca::on_ipi` on the target core
+auto send_ipi(u8 apic_id) -> void;
 
 [[noreturn]] auto start() -> void;
 
@@ -138,8 +264,107 @@ auto inline interrupts_enable() -> void { asm volatile("sti"); }
 auto inline interrupts_disable() -> void { asm volatile("cli"); }
 auto inline halt() -> void { asm volatile("hlt"); }
 
+struct Cpuid {
+    u32 eax;
+    u32 ebx;
+    u32 ecx;
+    u32 edx;
+};
+
+// processor identification for `leaf` and `subleaf`
+auto inline cpuid(u32 const leaf, u32 const subleaf = 0) -> Cpuid {
+    auto r = Cpuid{};
+    asm volatile("cpuid"
+                 : "=a"(r.eax), "=b"(r.ebx), "=c"(r.ecx), "=d"(r.edx)
+                 : "a"(leaf), "c"(subleaf));
+    return r;
+}
+
+// reads the 64-bit time stamp counter (tsc)
+auto inline read_tsc() -> u64 {
+    auto low = 0u;
+    auto high = 0u;
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+    return (u64(high) << 32) | low;
+}
+
+// converts tsc ticks to nanoseconds using calibrated frequency
+// note: split in whole seconds and remainder to avoid overflow
+auto inline tsc_to_ns(u64 const ticks) -> u64 {
+    auto const hz = clock.tsc_ticks_per_sec;
+    return ticks / hz * 1'000'000'000 + ticks % hz * 1'000'000'000 / hz;
+}
+
+// local apic id of the running core
+auto inline apic_id() -> u8 { return u8(apic.local[0x020 / 4] >> 24); }
+
+// index in `cores` of the running core
+// note: gs base points to the core's entry in `cores`; set at core init
+auto inline index() -> u32 {
+    auto i = 0u;
+    asm volatile("movl %%gs:%c1, %0"
+                 : "=r"(i)
+                 : "i"(__builtin_offsetof(Core, index)));
+    return i;
+}
+
+// numa node of the running core
+auto inline node() -> u32 {
+    auto n = 0u;
+    asm volatile("movl %%gs:%c1, %0"
+                 : "=r"(n)
+                 : "i"(__builtin_offsetof(Core, node)));
+    return n;
+}
+
+// points gs base at the entry of the running core in `cores`
+auto inline set_index(u32 const i) -> void {
+    cores[i].index = i;
+    auto const base = uptr(&cores[i]);
+    // msr 0xc0000101: ia32_gs_base
+    asm volatile("wrmsr"
+                 :
+                 : "a"(u32(base)), "d"(u32(base >> 32)), "c"(0xc000'0101));
+}
+
 } // namespace kernel::core
 
+namespace kernel::boot {
+
+auto constexpr MAX_PHASES = 32u;
+
+// boot phase starting at `tsc`; ends where the next phase starts
+struct Phase {
+    char const* name;
+    u64 tsc;
+};
+
+struct Timeline {
+    Phase phases[MAX_PHASES];
+    u32 phase_count;
+    // application processor bring-up duration in tsc ticks by core index
+    u64 core_start_ticks[256];
+    // tsc when the keyboard acknowledged enable; 0 while pending
+    u64 keyboard_ready_tsc;
+    // enable commands sent until the acknowledge or giving up
+    u32 keyboard_attempts;
+    // nonzero if the keyboard never acknowledged enable
+    u32 keyboard_failed;
+};
+
+Timeline inline timeline;
+
+// records the start of a boot phase
+// note: timestamps are raw tsc ticks; converted after calibration
+auto inline mark(char const* const name) -> void {
+    if (timeline.phase_count < MAX_PHASES) {
+        timeline.phases[timeline.phase_count] = {name, core::read_tsc()};
+        ++timeline.phase_count;
+    }
+}
+
+} // namespace kernel::boot
+
 namespace kernel {
 
 [[noreturn]] auto inline panic(u32 const color) -> void {
@@ -156,13 +381,33 @@ namespace kernel {
 
 } // namespace kernel
 
-// kernel callback assembler functions
-extern "C" auto kernel_asm_timer_handler() -> void;
-extern "C" auto kernel_asm_keyboard_handler() -> void;
+namespace kernel::qemu {
+
+// powers off qemu through the isa-debug-exit device
+// note: requires `-device isa-debug-exit,iobase=0xf4,iosize=0x04`
+//       qemu exit status is `(code << 1) | 1`
+[[noreturn]] auto inline exit(u32 const code) -> void {
+    outl(0xf4, code);
+
+    // not running in qemu or device not present
+    core::interrupts_disable();
+    while (true) {
+        core::halt();
+    }
+}
+
+} // namespace kernel::qemu
+
+// handler per vector called by the interrupt stubs in `kernel_asm.s`
+extern "C" kernel::IsrHandler kernel_isr_handlers[256];
+
+// interrupt stub addresses per tier for vectors 32 to 47
+extern "C" uptr const kernel_asm_isr_minimal_stubs[];
+extern "C" uptr const kernel_asm_isr_full_stubs[];
 
-// kernel callback from assembler
+// interrupt handlers of the minimal tier in `kernel_isr.cpp`
 extern "C" auto kernel_on_timer() -> void;
-extern "C" auto kernel_on_keyboard() -> void;
+extern "C" auto kernel_on_probe() -> void;
 
 // binding to osca
 namespace osca {
@@ -170,7 +415,7 @@ namespace osca {
 [[noreturn]] auto start() -> void;
 [[noreturn]] auto run_core(u32 core_index) -> void;
 auto on_keyboard(u8 scancode) -> void;
-auto on_timer() -> void;
+auto on_ipi() -> void;
 
 } // namespace osca
 
@@ -194,6 +439,108 @@ extern "C" auto inline memcpy(void* dest, void const* src, u64 count) -> void* {
     return original_dest;
 }
 
+// copies forward when `dest` is below `src`, backward otherwise, so the ranges
+// may overlap
+extern "C" auto inline memmove(void* dest, void const* src, u64 count)
+    -> void* {
+    void* original_dest = dest;
+    if (uptr(dest) <= uptr(src) || uptr(dest) >= uptr(src) + count) {
+        asm volatile("rep movsb"
+                     : "+D"(dest), "+S"(src), "+c"(count)
+                     :
+                     : "memory");
+        return original_dest;
+    }
+    // overlapping with `dest` above `src`; backward from the last byte with the direction flag set
+    dest = static_cast<u8*>(dest) + count - 1;
+    src = static_cast<u8 const*>(src) + count - 1;
+    asm volatile("std\n\trep movsb\n\tcld"
+                 : "+D"(dest), "+S"(src), "+c"(count)
+                 :
+                 : "memory");
+    return original_dest;
+}
+
+namespace kernel {
+
+// memset with non-temporal stores bypassing the caches
+// note: for large buffers not read soon after; stores are fenced on return
+auto inline memset_nt(void* const s, i32 const c, u64 n) -> void {
+    auto* p = ptr<u8>(s);
+
+    // unaligned head
+    auto const head = (8 - uptr(p) % 8) % 8;
+    if (head >= n) {
+        memset(p, c, n);
+        return;
+    }
+    memset(p, c, head);
+    p += head;
+    n -= head;
+
+    auto const pattern = u64(u8(c)) * 0x01'01'01'01'01'01'01'01ull;
+    auto* q = ptr<u64>(p);
+    auto* const end = q + n / 8;
+    while (q < end) {
+        asm volatile("movnti %1, %0" : "=m"(*q) : "r"(pattern));
+        ++q;
+    }
+    asm volatile("sfence" : : : "memory");
+
+    // tail
+    memset(q, c, n % 8);
+}
+
+// memcpy with non-temporal stores bypassing the caches
+// note: for large buffers not read soon after; stores are fenced on return
+auto inline memcpy_nt(void* const dest, void const* const src, u64 n) -> void {
+    auto* d = ptr<u8>(dest);
+    auto const* s = ptr<u8 const>(src);
+
+    // unaligned destination head
+    auto const head = (8 - uptr(d) % 8) % 8;
+    if (head >= n) {
+        memcpy(d, s, n);
+        return;
+    }
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+    auto* q = ptr<u64>(d);
+    auto* const end = q + n / 8;
+    while (q < end) {
+        // note: unaligned source load; the builtin compiles to a single mov
+        u64 value;
+        __builtin_memcpy(&value, s, 8);
+        asm volatile("movnti %1, %0" : "=m"(*q) : "r"(value));
+        ++q;
+        s += 8;
+    }
+    asm volatile("sfence" : : : "memory");
+
+    // tail
+    memcpy(q, s, n % 8);
+}
+
+// copies whole cache lines with non-temporal stores without fencing
+// note: `dest` and `src` are 64 byte aligned and `n` is a multiple of 64;
+//       callers fence once with `sfence` after a batch, e.g. a presented frame
+auto inline memcpy_nt_lines(void* const dest, void const* const src,
+                            u64 const n) -> void {
+    auto* d = ptr<u64>(dest);
+    auto const* s = ptr<u64 const>(src);
+    auto* const end = d + n / 8;
+    while (d < end) {
+        asm volatile("movnti %1, %0" : "=m"(*d) : "r"(*s));
+        ++d;
+        ++s;
+    }
+}
+
+} // namespace kernel
+
 // placement new
 auto constexpr inline operator new(size_t, void* p) noexcept -> void* {
     return p;
@@ -202,6 +549,29 @@ auto constexpr inline operator new(size_t, void* p) noexcept -> void* {
 // placement delete
 auto constexpr inline operator delete(void*, void*) noexcept -> void {}
 
+// global allocation through the slab allocator
+// note: not constexpr to match the compiler's expected signatures
+auto inline operator new(size_t const size) -> void* {
+    return kernel::kmalloc(size);
+}
+
+auto inline operator new[](size_t const size) -> void* {
+    return kernel::kmalloc(size);
+}
+
+auto inline operator delete(void* const p) noexcept -> void {
+    kernel::kfree(p);
+}
+
+auto inline operator delete[](void* const p) noexcept -> void {
+    kernel::kfree(p);
+}
+
 // global sized deallocation
-// note: not constexpr to match the compiler's expected signature
-auto inline operator delete(void*, size_t) noexcept -> void {}
+auto inline operator delete(void* const p, size_t) noexcept -> void {
+    kernel::kfree(p);
+}
+
+auto inline operator delete[](void* const p, size_t) noexcept -> void {
+    kernel::kfree(p);
+}
@@ -1,8 +1,38 @@
-.global kernel_asm_timer_handler
-.global kernel_asm_keyboard_handler
+.global kernel_asm_isr_minimal_stubs
+.global kernel_asm_isr_full_stubs
 .global kernel_asm_run_core_start
 .global kernel_asm_run_core_end
 .global kernel_asm_run_core_config
+.global kernel_asm_xsave_size
+.global kernel_asm_xsave_mask
+.global kernel_asm_xsave_mode
+
+# caller-saved general purpose registers of the ms x64 abi
+# note: 7 pushes on the 40 byte interrupt frame leave rsp 16 byte aligned
+.macro PUSH_VOLATILE
+    push %rax
+    push %rcx
+    push %rdx
+    push %r8
+    push %r9
+    push %r10
+    push %r11
+
+    # shadow space for the callee (ms x64 abi)
+    sub $32, %rsp
+.endm
+
+.macro POP_VOLATILE
+    add $32, %rsp
+
+    pop %r11
+    pop %r10
+    pop %r9
+    pop %r8
+    pop %rdx
+    pop %rcx
+    pop %rax
+.endm
 
 .macro PUSH_ALL
     push %rax
@@ -25,21 +55,47 @@
     # guarantees the handler will restore it if it touches it
     mov %rsp, %r12
 
-    # alignment for xsave performance
-    sub $1024, %rsp
-    # clear the lower 6 bits (0x3F)
+    # save area sized at boot for the components enabled in xcr0
+    sub kernel_asm_xsave_size(%rip), %rsp
+    # clear the lower 6 bits (0x3F); xsave requires 64 byte alignment
     and $-64, %rsp
 
-    # xsave mask: 7 (x87 | SSE | AVX)
-    mov $7, %eax
-    xor %edx, %edx
+    # xsave mask: components enabled in xcr0
+    mov kernel_asm_xsave_mask(%rip), %eax
+    mov kernel_asm_xsave_mask+4(%rip), %edx
+
+    # xsavec: compacted, skips components in init state
+    # xsave: standard, saves every component in the mask
+    # note: not xsaveopt; it skips components unmodified since the last
+    #       xrstor from the same address, but this area is on the stack and
+    #       overwritten between interrupts
+    # note: standard format requires a zeroed header except xstate_bv
+    cmpb $1, kernel_asm_xsave_mode(%rip)
+    jne 1f
+    xsavec (%rsp)
+    jmp 2f
+1:
+    movq $0, 512(%rsp)
+    movq $0, 520(%rsp)
+    movq $0, 528(%rsp)
+    movq $0, 536(%rsp)
+    movq $0, 544(%rsp)
+    movq $0, 552(%rsp)
+    movq $0, 560(%rsp)
+    movq $0, 568(%rsp)
     xsave (%rsp)
+2:
+    # shadow space for the callee (ms x64 abi)
+    sub $32, %rsp
 .endm
 
 .macro POP_ALL
+    add $32, %rsp
+
     # restore the extended state
-    mov $7, %eax
-    xor %edx, %edx
+    # note: xrstor reads the format from the header
+    mov kernel_asm_xsave_mask(%rip), %eax
+    mov kernel_asm_xsave_mask+4(%rip), %edx
     xrstor (%rsp)
 
     # snap rsp back to the state before alignment/allocation
@@ -62,19 +118,32 @@
     pop %rax
 .endm
 
-kernel_asm_timer_handler:
-    PUSH_ALL
+# minimal tier: handler compiled with `-mgeneral-regs-only` keeps
+# callee-saved registers and does not touch simd state
+.macro ISR_MINIMAL vector
+kernel_asm_isr_minimal_\vector:
+    PUSH_VOLATILE
     cld
-    call kernel_on_timer
-    POP_ALL
+    call *(kernel_isr_handlers + 8 * \vector)(%rip)
+    POP_VOLATILE
     iretq
+.endm
 
-kernel_asm_keyboard_handler:
+# full tier: handler may use any register including simd
+.macro ISR_FULL vector
+kernel_asm_isr_full_\vector:
     PUSH_ALL
     cld
-    call kernel_on_keyboard
+    call *(kernel_isr_handlers + 8 * \vector)(%rip)
     POP_ALL
     iretq
+.endm
+
+# stubs for vectors 32 to 47 in both tiers
+.irp vector, 32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47
+    ISR_MINIMAL \vector
+    ISR_FULL \vector
+.endr
 
 //
 // used by kernel to launch code on a core 
@@ -155,11 +224,24 @@ kernel_asm_run_core_start:
     movw %ax, %ds
     movw %ax, %es
 
-    # setup stack
-    movq 8(%rsi), %rsp    # 8 = offset of stack pointer
+    # initial apic id of this core: cpuid 1 ebx bits 31:24
+    movl $1, %eax
+    cpuid
+    shrl $24, %ebx
+
+    # take a ticket: unique index of this core
+    movl $1, %ecx
+    lock xaddl %ecx, 32(%rsi) # 32 = offset of ticket
+
+    # setup stack from the slot of the apic id
+    movq 8(%rsi), %rdx    # 8 = offset of stacks array
+    movq (%rdx,%rbx,8), %rsp
     movq %rsp, %rbp
 
-    # call target
+    # shadow space for the callee (ms x64 abi)
+    subq $32, %rsp
+
+    # call target with ticket as first argument in rcx (ms x64 abi)
     movq 16(%rsi), %rax   # 16 = offset of call target pointer
     call *%rax            # calling no return task
 
@@ -176,6 +258,36 @@ kernel_asm_run_core_start:
 
 .align 16
 kernel_asm_run_core_config:
-    .fill 32, 1, 0
+    .fill 40, 1, 0
 
 kernel_asm_run_core_end:
+
+//
+// interrupt extended state save; written by `init_xsave` on the bsp before
+// interrupts are enabled
+//
+
+.data
+.balign 8
+kernel_asm_xsave_size:
+    .quad 1024 # bytes reserved, including alignment slack
+kernel_asm_xsave_mask:
+    .quad 7    # x87 | sse | avx
+kernel_asm_xsave_mode:
+    .quad 0    # 0: xsave, 1: xsavec
+
+//
+// stub addresses for vectors 32 to 47 per tier; installed in the idt by
+// `register_interrupt`
+//
+
+.balign 8
+kernel_asm_isr_minimal_stubs:
+.irp vector, 32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47
+    .quad kernel_asm_isr_minimal_\vector
+.endr
+
+kernel_asm_isr_full_stubs:
+.irp vector, 32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47
+    .quad kernel_asm_isr_full_\vector
+.endr
@@ -0,0 +1,26 @@
+#include "atomic.hpp"
+#include "kernel.hpp"
+
+// interrupt handlers of the minimal tier
+// note: compiled with `-mgeneral-regs-only`; the minimal stubs do not save
+//       simd state so nothing called from here may touch it
+
+// handlers by vector; read by the interrupt stubs
+extern "C" kernel::IsrHandler kernel_isr_handlers[256]{};
+
+// lapic timer interrupt handler
+extern "C" auto kernel_on_timer() -> void {
+    atomic::add(&kernel::ticks, 1ull, atomic::RELAXED);
+
+    // write any value (conventionally 0) to EOI register
+    kernel::apic.local[0x0b0 / 4] = 0;
+}
+
+// empty handler of `interrupt_self`
+// note: registered for both tiers
+extern "C" auto kernel_on_probe() -> void {
+    atomic::add(&kernel::probes, 1ull, atomic::RELAXED);
+
+    // write any value (conventionally 0) to EOI register
+    kernel::apic.local[0x0b0 / 4] = 0;
+}
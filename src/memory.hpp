@@ -0,0 +1,858 @@
+#pragma once
+
+#include "atomic.hpp"
+#include "config.hpp"
+#include "kernel.hpp"
+#include "types.hpp"
+
+namespace kernel::memory {
+
+auto constexpr PAGE_SIZE = 0x1000ull;
+
+// block orders; a block of order `n` is `1 << n` pages
+auto constexpr ORDER_4K = 0u;
+auto constexpr ORDER_2M = 9u;
+auto constexpr ORDER_1G = 18u;
+auto constexpr MAX_ORDER = ORDER_1G;
+
+// smallest order with `1 << order >= pages`
+auto constexpr inline order_for(u64 const pages) -> u32 {
+    auto order = 0u;
+    while ((1ull << order) < pages) {
+        ++order;
+    }
+    return order;
+}
+
+//
+// buddy allocator of physical page frames
+//
+// free blocks are kept clean (known zero) or dirty on separate lists; merged
+// blocks are clean only if both halves are
+//
+// thread safety:
+//  * none; callers serialize
+//
+// constraints:
+//  * span start is 1GB aligned so blocks of every order are naturally aligned
+//  * metadata is one byte per page in span, provided by caller
+//  * free blocks hold their list links in their first 16 bytes; memory must be
+//    identity mapped and writable
+//
+class Buddy final {
+    struct FreeBlock {
+        FreeBlock* next;
+        FreeBlock* prev;
+    };
+
+    // metadata of the first page of a free block: `FREE | [CLEAN] | order`
+    // all other pages: 0
+    static auto constexpr FREE = u8(0x80);
+    static auto constexpr CLEAN = u8(0x40);
+    static auto constexpr ORDER_MASK = u8(0x3f);
+
+    static auto constexpr DIRTY_LIST = 0u;
+    static auto constexpr CLEAN_LIST = 1u;
+
+    uptr base_;
+    u64 page_count_;
+    u8* meta_;
+    FreeBlock* free_[2][MAX_ORDER + 1];
+    u64 free_count_[2][MAX_ORDER + 1];
+    u64 total_pages_;
+    u64 free_pages_;
+    u64 clean_pages_;
+
+    auto address_of(u64 const index) const -> uptr {
+        return base_ + index * PAGE_SIZE;
+    }
+
+    auto index_of(uptr const address) const -> u64 {
+        return (address - base_) / PAGE_SIZE;
+    }
+
+    auto push(u64 const index, u32 const order, bool const clean) -> void {
+        auto const list = clean ? CLEAN_LIST : DIRTY_LIST;
+        auto* const block = ptr<FreeBlock>(address_of(index));
+        block->prev = nullptr;
+        block->next = free_[list][order];
+        if (free_[list][order]) {
+            free_[list][order]->prev = block;
+        }
+        free_[list][order] = block;
+        meta_[index] = FREE | (clean ? CLEAN : 0) | u8(order);
+        ++free_count_[list][order];
+        if (clean) {
+            clean_pages_ += 1ull << order;
+        }
+    }
+
+    // returns true if block was clean
+    // note: links of a clean block are zeroed so it stays clean
+    auto remove(u64 const index, u32 const order) -> bool {
+        auto const clean = (meta_[index] & CLEAN) != 0;
+        auto const list = clean ? CLEAN_LIST : DIRTY_LIST;
+        auto* const block = ptr<FreeBlock>(address_of(index));
+        if (block->prev) {
+            block->prev->next = block->next;
+        } else {
+            free_[list][order] = block->next;
+        }
+        if (block->next) {
+            block->next->prev = block->prev;
+        }
+        meta_[index] = 0;
+        --free_count_[list][order];
+        if (clean) {
+            block->next = nullptr;
+            block->prev = nullptr;
+            clean_pages_ -= 1ull << order;
+        }
+        return clean;
+    }
+
+    // inserts block merging it with free buddies
+    auto release(u64 index, u32 order, bool clean) -> void {
+        while (order < MAX_ORDER) {
+            auto const buddy = index ^ (1ull << order);
+            if (buddy >= page_count_ ||
+                (meta_[buddy] & (FREE | ORDER_MASK)) != (FREE | order)) {
+                break;
+            }
+            clean = remove(buddy, order) && clean;
+            index &= ~(1ull << order);
+            ++order;
+        }
+        push(index, order, clean);
+    }
+
+    // inserts pages `[index, end)` as the largest naturally aligned blocks
+    auto release_range(u64 index, u64 const end, bool const clean) -> void {
+        while (index < end) {
+            auto order = 0u;
+            while (order < MAX_ORDER && (index & (1ull << order)) == 0 &&
+                   index + (2ull << order) <= end) {
+                ++order;
+            }
+            release(index, order, clean);
+            index += 1ull << order;
+        }
+    }
+
+    // first block of list at `order` or above; MAX_ORDER + 1 if none
+    auto find(u32 const list, u32 order) const -> u32 {
+        while (order <= MAX_ORDER && !free_[list][order]) {
+            ++order;
+        }
+        return order;
+    }
+
+  public:
+    struct Block {
+        void* address;
+        bool clean; // known zero
+    };
+
+    // span `[base, base + page_count * PAGE_SIZE)` with `meta` holding
+    // `page_count` bytes
+    auto init(uptr const base, u64 const page_count, u8* const meta) -> void {
+        base_ = base;
+        page_count_ = page_count;
+        meta_ = meta;
+        memset(meta_, 0, page_count);
+        for (auto i = 0u; i <= MAX_ORDER; ++i) {
+            free_[DIRTY_LIST][i] = nullptr;
+            free_[CLEAN_LIST][i] = nullptr;
+            free_count_[DIRTY_LIST][i] = 0;
+            free_count_[CLEAN_LIST][i] = 0;
+        }
+        total_pages_ = 0;
+        free_pages_ = 0;
+        clean_pages_ = 0;
+    }
+
+    // adds free memory `[start, end)`; page aligned and within span
+    auto add(uptr const start, uptr const end) -> void {
+        release_range(index_of(start), index_of(end), false);
+        auto const pages = (end - start) / PAGE_SIZE;
+        total_pages_ += pages;
+        free_pages_ += pages;
+    }
+
+    // allocates a naturally aligned block of `1 << order` pages
+    // `want_clean` prefers clean blocks, otherwise dirty blocks are preferred
+    // keeping clean ones for callers that need zeroed memory
+    // returns nullptr address if no block is available
+    auto allocate_block(u32 const order, bool const want_clean) -> Block {
+        auto list = want_clean ? CLEAN_LIST : DIRTY_LIST;
+        auto o = find(list, order);
+        if (o > MAX_ORDER) {
+            list ^= 1;
+            o = find(list, order);
+            if (o > MAX_ORDER) {
+                return {nullptr, false};
+            }
+        }
+
+        auto const index = index_of(uptr(free_[list][o]));
+        auto const clean = remove(index, o);
+
+        // split; upper halves go back to free lists
+        while (o > order) {
+            --o;
+            push(index + (1ull << o), o, clean);
+        }
+
+        free_pages_ -= 1ull << order;
+        return {ptr<void>(address_of(index)), clean};
+    }
+
+    // frees a block from `allocate_block`; `clean` if known zero
+    auto free_block(void* const p, u32 const order, bool const clean = false)
+        -> void {
+        release(index_of(uptr(p)), order, clean);
+        free_pages_ += 1ull << order;
+    }
+
+    // allocates `pages` contiguous pages
+    // the tail of the rounded up block is returned to the free lists
+    // returns nullptr address if no block is available
+    auto allocate(u64 const pages, bool const want_clean) -> Block {
+        auto const order = order_for(pages);
+        auto const block = allocate_block(order, want_clean);
+        if (!block.address) {
+            return block;
+        }
+        auto const index = index_of(uptr(block.address));
+        release_range(index + pages, index + (1ull << order), block.clean);
+        free_pages_ += (1ull << order) - pages;
+        return block;
+    }
+
+    // frees `pages` pages starting at `p`
+    // note: any page run within previous allocations may be freed
+    auto free(void* const p, u64 const pages) -> void {
+        auto const index = index_of(uptr(p));
+        release_range(index, index + pages, false);
+        free_pages_ += pages;
+    }
+
+    // takes a dirty block of `order`, splitting a larger one if needed, or the
+    // largest smaller dirty block
+    // returns nullptr address if all free memory is clean
+    // note: give back with `free_block(p, order, true)` once zeroed
+    auto take_dirty(u32 const order, u32& taken_order) -> void* {
+        auto o = find(DIRTY_LIST, order);
+        if (o > MAX_ORDER) {
+            o = order;
+            while (o > 0 && !free_[DIRTY_LIST][o]) {
+                --o;
+            }
+            if (!free_[DIRTY_LIST][o]) {
+                return nullptr;
+            }
+        }
+
+        auto const index = index_of(uptr(free_[DIRTY_LIST][o]));
+        remove(index, o);
+        while (o > order) {
+            --o;
+            push(index + (1ull << o), o, false);
+        }
+
+        taken_order = o;
+        free_pages_ -= 1ull << o;
+        return ptr<void>(address_of(index));
+    }
+
+    auto total_bytes() const -> u64 { return total_pages_ * PAGE_SIZE; }
+
+    auto free_bytes() const -> u64 { return free_pages_ * PAGE_SIZE; }
+
+    auto clean_bytes() const -> u64 { return clean_pages_ * PAGE_SIZE; }
+
+    // true if some free memory is dirty and less than `pool_bytes` is clean
+    // note: callable without the lock; the result may be stale
+    auto wants_zeroing(u64 const pool_bytes) const -> bool {
+        auto const free = atomic::load(&free_pages_, atomic::RELAXED);
+        auto const clean = atomic::load(&clean_pages_, atomic::RELAXED);
+        return free > clean && clean * PAGE_SIZE < pool_bytes;
+    }
+
+    // free blocks of `order`
+    auto free_blocks(u32 const order) const -> u64 {
+        return free_count_[DIRTY_LIST][order] + free_count_[CLEAN_LIST][order];
+    }
+};
+
+// buddy allocator per numa node
+Buddy inline frames[MAX_NUMA_NODES];
+
+// free bytes of all nodes
+auto inline free_bytes() -> u64 {
+    auto sum = 0ull;
+    for (auto i = 0u; i < numa.node_count; ++i) {
+        sum += frames[i].free_bytes();
+    }
+    return sum;
+}
+
+// clean (known zero) free bytes of all nodes
+auto inline clean_bytes() -> u64 {
+    auto sum = 0ull;
+    for (auto i = 0u; i < numa.node_count; ++i) {
+        sum += frames[i].clean_bytes();
+    }
+    return sum;
+}
+
+// bytes zeroed on and off the allocation path
+struct ZeroStats {
+    u64 idle_bytes;      // zeroed by idle cores ahead of time
+    u64 prezeroed_bytes; // allocated already zero
+    u64 sync_bytes;      // zeroed at allocation
+};
+
+//
+// page allocator safe to use from any core
+//
+// every numa node has its own buddy allocator in `frames`; allocations go to
+// the requested node first and fall back to the nearest node with free memory
+//
+// single pages for the calling core's node are served from per-core magazines
+// refilled and drained in batches; other requests go to `frames` in a short
+// critical section of the node
+//
+// idle cores zero dirty free blocks of their node with non-temporal stores
+// until `config::ZERO_POOL_BYTES` are clean so zeroed allocations mostly skip
+// the memset
+//
+// thread safety:
+//  * allocate(), free(), zero_idle(), count_zeroed(): any core
+//  * zero_stats(): any core; approximate while other cores allocate
+//
+// constraints:
+//  * not callable from interrupt handlers
+//  * `core::index()` and `core::node()` valid on the calling core
+//  * magazine pages are treated as dirty
+//
+class Pages final {
+    static auto constexpr MAGAZINE_SIZE = 64u;
+    static auto constexpr BATCH_SIZE = MAGAZINE_SIZE / 2;
+
+    // 256KB zeroed per idle step bounding the delay before an idle core picks
+    // up new work
+    static auto constexpr ZERO_ORDER = 6u;
+
+    // most idle steps skipped after finding nothing to zero
+    static auto constexpr ZERO_BACKOFF_MAX = 1024u;
+
+    struct alignas(core::CACHE_LINE_SIZE) Magazine {
+        void* pages[MAGAZINE_SIZE];
+        u32 count;
+    };
+
+    // idle steps of a core left to skip and skipped after the last miss
+    struct alignas(core::CACHE_LINE_SIZE) ZeroBackoff {
+        u32 skip;
+        u32 backoff;
+    };
+
+    struct alignas(core::CACHE_LINE_SIZE) NodeLock {
+        atomic::Spinlock lock;
+    };
+
+    // note: different cache lines avoiding false sharing
+
+    // any core, in critical section of the node
+    NodeLock locks_[MAX_NUMA_NODES];
+
+    // any core, atomic adds
+    alignas(core::CACHE_LINE_SIZE) ZeroStats zero_stats_;
+
+    // owning core reads and writes
+    Magazine magazines_[256];
+
+    // owning core reads and writes
+    ZeroBackoff zero_backoffs_[256];
+
+    // pages of the calling core's node, nearest other nodes when exhausted
+    auto refill(Magazine& m) -> void {
+        auto const* const order = numa.order[core::node()];
+        for (auto i = 0u; i < numa.node_count && m.count < BATCH_SIZE; ++i) {
+            auto const node = order[i];
+            locks_[node].lock.lock();
+            while (m.count < BATCH_SIZE) {
+                auto* const p =
+                    frames[node].allocate_block(ORDER_4K, false).address;
+                if (!p) {
+                    break;
+                }
+                m.pages[m.count] = p;
+                ++m.count;
+            }
+            locks_[node].lock.unlock();
+        }
+    }
+
+    // note: pages freed on another node's core go back to their node
+    auto drain(Magazine& m) -> void {
+        while (m.count > BATCH_SIZE) {
+            --m.count;
+            auto* const p = m.pages[m.count];
+            auto const node = node_of(uptr(p));
+            locks_[node].lock.lock();
+            frames[node].free_block(p, ORDER_4K);
+            locks_[node].lock.unlock();
+        }
+    }
+
+  public:
+    // allocates `pages` contiguous pages on `node` or the nearest node with
+    // free memory; not zeroed unless `clean` in result
+    // `want_clean` prefers clean memory for callers that zero it
+    // returns nullptr address if out of memory
+    auto allocate(u64 const pages, bool const want_clean,
+                  u32 node = NODE_LOCAL) -> Buddy::Block {
+        auto const local = core::node();
+        if (node == NODE_LOCAL) {
+            node = local;
+        }
+
+        if (pages == 1 && node == local) {
+            auto& m = magazines_[core::index()];
+            if (m.count == 0) {
+                refill(m);
+                if (m.count == 0) {
+                    return {nullptr, false};
+                }
+            }
+            --m.count;
+            return {m.pages[m.count], false};
+        }
+
+        for (auto i = 0u; i < numa.node_count; ++i) {
+            auto const n = numa.order[node][i];
+            locks_[n].lock.lock();
+            auto const block = frames[n].allocate(pages, want_clean);
+            locks_[n].lock.unlock();
+            if (block.address) {
+                return block;
+            }
+        }
+        return {nullptr, false};
+    }
+
+    // frees `pages` pages starting at `p`
+    auto free(void* const p, u64 const pages) -> void {
+        if (pages == 1) {
+            auto& m = magazines_[core::index()];
+            if (m.count == MAGAZINE_SIZE) {
+                drain(m);
+            }
+            m.pages[m.count] = p;
+            ++m.count;
+            return;
+        }
+
+        auto const node = node_of(uptr(p));
+        locks_[node].lock.lock();
+        frames[node].free(p, pages);
+        locks_[node].lock.unlock();
+    }
+
+    // zeroes one dirty free block of up to 256KB of the calling core's node
+    // outside the critical section
+    // returns false if nothing was zeroed
+    // note: after finding nothing to zero, the next calls return false
+    //       without looking; twice as many after every further miss
+    auto zero_idle() -> bool {
+        auto const node = core::node();
+        auto& buddy = frames[node];
+        auto& b = zero_backoffs_[core::index()];
+
+        if (b.skip > 0) {
+            --b.skip;
+            return false;
+        }
+
+        // unlocked check keeps idle cores off the node lock while the pool
+        // is full or all free memory is clean
+        if (!buddy.wants_zeroing(config::ZERO_POOL_BYTES)) {
+            if (b.backoff < ZERO_BACKOFF_MAX) {
+                b.backoff = b.backoff == 0 ? 1 : b.backoff * 2;
+            }
+            b.skip = b.backoff;
+            return false;
+        }
+        b.backoff = 0;
+
+        locks_[node].lock.lock();
+        auto order = 0u;
+        auto* p = static_cast<void*>(nullptr);
+        if (buddy.clean_bytes() < config::ZERO_POOL_BYTES) {
+            p = buddy.take_dirty(ZERO_ORDER, order);
+        }
+        locks_[node].lock.unlock();
+        if (!p) {
+            return false;
+        }
+
+        auto const bytes = PAGE_SIZE << order;
+        memset_nt(p, 0, bytes);
+
+        locks_[node].lock.lock();
+        buddy.free_block(p, order, true);
+        locks_[node].lock.unlock();
+        atomic::add(&zero_stats_.idle_bytes, bytes, atomic::RELAXED);
+        return true;
+    }
+
+    // records `bytes` handed out zeroed; `prezeroed` if no memset was needed
+    auto count_zeroed(u64 const bytes, bool const prezeroed) -> void {
+        atomic::add(prezeroed ? &zero_stats_.prezeroed_bytes
+                              : &zero_stats_.sync_bytes,
+                    bytes, atomic::RELAXED);
+    }
+
+    auto zero_stats() const -> ZeroStats { return zero_stats_; }
+};
+
+Pages inline pages;
+
+// object sizes served from slabs; larger go directly to `pages`
+// note: power-of-two and cache line multiple classes; objects of 64 bytes and
+//       up are cache line aligned
+u32 inline constexpr SLAB_SIZE_CLASSES[]{16,  32,  64,  128, 192,  256,
+                                         384, 512, 768, 1024, 2048};
+
+auto constexpr SLAB_CLASS_COUNT =
+    u32(sizeof(SLAB_SIZE_CLASSES) / sizeof(SLAB_SIZE_CLASSES[0]));
+
+// smallest size class index fitting `size`; `SLAB_CLASS_COUNT` if none
+auto constexpr inline slab_class_for(u64 const size) -> u32 {
+    auto i = 0u;
+    while (i < SLAB_CLASS_COUNT && SLAB_SIZE_CLASSES[i] < size) {
+        ++i;
+    }
+    return i;
+}
+
+struct SlabStats {
+    u64 allocs;
+    u64 frees;
+    u64 remote_frees;
+    u64 slabs;
+    u64 large_allocs;
+    u64 large_frees;
+};
+
+//
+// size class slab allocator with per-core freelists
+//
+// every slab belongs to the core that created it; objects freed by another
+// core are pushed on the owner's lock-free remote stack and moved to the
+// owner's freelists on its next miss
+//
+// thread safety:
+//  * allocate(), free(): any core
+//  * stats(): any core; approximate while other cores allocate
+//
+// constraints:
+//  * not callable from interrupt handlers
+//  * slabs are kept by their size class once created
+//  * allocations larger than the biggest class take at least 16KB
+//
+class Slabs final {
+    static auto constexpr SLAB_PAGES = 4u;
+    static auto constexpr SLAB_BYTES = SLAB_PAGES * PAGE_SIZE;
+
+    // header at the start of every 16KB aligned slab or large allocation
+    // note: objects and large allocations start after the header
+    struct alignas(core::CACHE_LINE_SIZE) Header {
+        u32 size_class; // `SLAB_CLASS_COUNT` for large allocations
+        u32 owner;      // core index
+        u64 pages;      // pages in large allocation
+    };
+
+    static auto constexpr HEADER_SIZE = sizeof(Header);
+
+    struct FreeObject {
+        FreeObject* next;
+    };
+
+    struct alignas(core::CACHE_LINE_SIZE) Cache {
+        // owning core reads and writes
+        FreeObject* free[SLAB_CLASS_COUNT];
+        SlabStats stats;
+
+        // any core pushes, owning core takes all
+        alignas(core::CACHE_LINE_SIZE) FreeObject* remote;
+    };
+
+    Cache caches_[256];
+
+    static auto header_of(void* const p) -> Header* {
+        return ptr<Header>(uptr(p) & ~(SLAB_BYTES - 1));
+    }
+
+    // moves objects freed by other cores to the local freelists
+    auto reclaim(Cache& c) -> void {
+        // (1) paired with release (2)
+        FreeObject* obj = atomic::exchange(
+            &c.remote, static_cast<FreeObject*>(nullptr), atomic::ACQUIRE);
+        while (obj) {
+            auto* const next = obj->next;
+            auto const cls = header_of(obj)->size_class;
+            obj->next = c.free[cls];
+            c.free[cls] = obj;
+            obj = next;
+        }
+    }
+
+    // carves a new slab into the freelist of `cls`
+    auto grow(Cache& c, u32 const cls, u32 const owner) -> bool {
+        auto* const slab = pages.allocate(SLAB_PAGES, false).address;
+        if (!slab) {
+            return false;
+        }
+
+        auto* const h = ptr<Header>(slab);
+        *h = {.size_class = cls, .owner = owner, .pages = SLAB_PAGES};
+
+        auto const size = SLAB_SIZE_CLASSES[cls];
+        for (auto off = HEADER_SIZE; off + size <= SLAB_BYTES; off += size) {
+            auto* const obj = ptr_offset<FreeObject>(slab, off);
+            obj->next = c.free[cls];
+            c.free[cls] = obj;
+        }
+
+        ++c.stats.slabs;
+        return true;
+    }
+
+    auto allocate_large(Cache& c, u64 const size, u32 const owner) -> void* {
+        // note: at least a 16KB block so the header is found by alignment
+        auto const n = (size + HEADER_SIZE + PAGE_SIZE - 1) / PAGE_SIZE;
+        auto const count = n < SLAB_PAGES ? SLAB_PAGES : n;
+        auto* const block = pages.allocate(count, false).address;
+        if (!block) {
+            return nullptr;
+        }
+
+        *ptr<Header>(block) = {
+            .size_class = SLAB_CLASS_COUNT, .owner = owner, .pages = count};
+
+        ++c.stats.large_allocs;
+        return ptr_offset<void>(block, HEADER_SIZE);
+    }
+
+  public:
+    // allocates `size` bytes; not zeroed
+    // returns nullptr if out of memory
+    auto allocate(u64 const size) -> void* {
+        auto const owner = core::index();
+        auto& c = caches_[owner];
+
+        auto const cls = slab_class_for(size);
+        if (cls == SLAB_CLASS_COUNT) {
+            return allocate_large(c, size, owner);
+        }
+
+        if (!c.free[cls]) {
+            reclaim(c);
+            if (!c.free[cls] && !grow(c, cls, owner)) {
+                return nullptr;
+            }
+        }
+
+        auto* const obj = c.free[cls];
+        c.free[cls] = obj->next;
+        ++c.stats.allocs;
+        return obj;
+    }
+
+    // frees memory from `allocate`; nullptr is ignored
+    auto free(void* const p) -> void {
+        if (!p) {
+            return;
+        }
+
+        auto const self = core::index();
+        auto& c = caches_[self];
+        auto* const h = header_of(p);
+
+        if (h->size_class == SLAB_CLASS_COUNT) {
+            ++c.stats.large_frees;
+            pages.free(h, h->pages);
+            return;
+        }
+
+        auto* const obj = ptr<FreeObject>(p);
+
+        if (h->owner == self) {
+            obj->next = c.free[h->size_class];
+            c.free[h->size_class] = obj;
+            ++c.stats.frees;
+            return;
+        }
+
+        // push on owner's remote stack
+        auto& owner = caches_[h->owner];
+        auto* head = atomic::load(&owner.remote, atomic::RELAXED);
+        do {
+            obj->next = head;
+            // (2) paired with acquire (1)
+            // note: release publishes `next` to the reclaiming owner
+        } while (!atomic::compare_exchange(&owner.remote, &head, obj, true,
+                                           atomic::RELEASE, atomic::RELAXED));
+        ++c.stats.remote_frees;
+    }
+
+    // sums of all cores
+    auto stats() const -> SlabStats {
+        auto sum = SlabStats{};
+        for (auto const& c : caches_) {
+            sum.allocs += c.stats.allocs;
+            sum.frees += c.stats.frees;
+            sum.remote_frees += c.stats.remote_frees;
+            sum.slabs += c.stats.slabs;
+            sum.large_allocs += c.stats.large_allocs;
+            sum.large_frees += c.stats.large_frees;
+        }
+        return sum;
+    }
+};
+
+Slabs inline slabs;
+
+//
+// per-core linear arenas for temporary memory reset once per frame
+//
+// every core bumps its own region; `reset` increments a generation and each
+// region rewinds on its core's next allocation, making reset O(1)
+//
+// thread safety:
+//  * allocate(), mark(), rewind(): any core, on its own region
+//  * reset(): one core while no other core uses the arena
+//  * peak_bytes(): any core; approximate while other cores allocate
+//
+// constraints:
+//  * not callable from interrupt handlers
+//  * memory is not zeroed and is invalid after `reset`
+//
+class FrameArena final {
+    struct alignas(core::CACHE_LINE_SIZE) Region {
+        u8* base;
+        u64 used;
+        u64 peak;
+        u32 generation;
+    };
+
+    // owning core reads and writes
+    Region regions_[256];
+
+    u64 region_bytes_;
+
+    // written by `reset`, read by all cores
+    // note: jobs handed over through the job queue see the value of the frame
+    //       they were added in
+    alignas(core::CACHE_LINE_SIZE) u32 generation_;
+
+    auto region() -> Region& {
+        auto& r = regions_[core::index()];
+        auto const generation = atomic::load(&generation_, atomic::RELAXED);
+        if (r.generation != generation) {
+            r.generation = generation;
+            r.used = 0;
+        }
+        return r;
+    }
+
+  public:
+    // allocates `region_bytes` for each of `core_count` cores on their node
+    auto init(u64 const region_bytes) -> void {
+        region_bytes_ = region_bytes;
+        generation_ = 0;
+        auto const pages = (region_bytes + PAGE_SIZE - 1) / PAGE_SIZE;
+        for (auto i = 0u; i < core_count; ++i) {
+            regions_[i] = {
+                .base = ptr<u8>(allocate_pages_uninit(pages, cores[i].node)),
+                .used = 0,
+                .peak = 0,
+                .generation = 0,
+            };
+        }
+    }
+
+    // invalidates all allocations of all cores
+    auto reset() -> void {
+        atomic::add(&generation_, 1u, atomic::RELAXED);
+    }
+
+    // allocates `size` bytes aligned to `align` (power of 2) from the calling
+    // core's region
+    // returns nullptr if region is full
+    auto allocate(u64 const size, u64 const align = 16) -> void* {
+        auto& r = region();
+        auto const start = (r.used + align - 1) & ~(align - 1);
+        if (start + size > region_bytes_) {
+            return nullptr;
+        }
+        r.used = start + size;
+        if (r.used > r.peak) {
+            r.peak = r.used;
+        }
+        return r.base + start;
+    }
+
+    // current position of the calling core's region
+    auto mark() -> u64 { return region().used; }
+
+    // frees allocations of the calling core made after `mark`
+    auto rewind(u64 const mark) -> void { region().used = mark; }
+
+    // most bytes used by any core since `init`
+    auto peak_bytes() const -> u64 {
+        auto peak = 0ull;
+        for (auto i = 0u; i < core_count; ++i) {
+            if (regions_[i].peak > peak) {
+                peak = regions_[i].peak;
+            }
+        }
+        return peak;
+    }
+};
+
+//
+// scope in the calling core's `FrameArena` region; allocations are released
+// when it goes out of scope
+//
+// constraints:
+//  * created and destroyed on the same core, e.g. within a job
+//  * scopes nest; inner scopes end first
+//
+class ScopedArena final {
+    FrameArena& arena_;
+    u64 const mark_;
+
+  public:
+    explicit ScopedArena(FrameArena& arena)
+        : arena_{arena}, mark_{arena.mark()} {}
+
+    ~ScopedArena() { arena_.rewind(mark_); }
+
+    ScopedArena(ScopedArena const&) = delete;
+    auto operator=(ScopedArena const&) -> ScopedArena& = delete;
+
+    // see `FrameArena::allocate`
+    auto allocate(u64 const size, u64 const align = 16) -> void* {
+        return arena_.allocate(size, align);
+    }
+
+    template <typename T> auto allocate_array(u64 const count) -> T* {
+        return ptr<T>(allocate(count * sizeof(T), alignof(T)));
+    }
+};
+
+} // namespace kernel::memory
@@ -1,7 +1,10 @@
 #include "osca.hpp"
-#include "ascii_font_8x8.hpp"
 #include "config.hpp"
+#include "console.hpp"
+#include "font.hpp"
+#include "fractal.hpp"
 #include "kernel.hpp"
+#include "memory.hpp"
 
 namespace {
 
@@ -16,23 +19,13 @@ auto draw_rect(u32 const x, u32 const y, u32 const width, u32 const height,
     }
 }
 
-auto draw_char(u32 const col, u32 const row, u32 const color, char c,
+auto draw_char(u32 const col, u32 const row, u32 const color, char const c,
                u32 const scale = 1) -> void {
-
-    auto fb = kernel::frame_buffer.pixels;
-    auto stride = kernel::frame_buffer.stride;
-    if (c < 32 || c > 126) {
-        c = '?';
-    }
-    auto glyph = ASCII_FONT[u8(c)];
-    for (auto i = 0u; i < 8; ++i) {
-        for (auto j = 0u; j < 8; ++j) {
-            if (glyph[i] & (1 << (7 - j))) {
-                draw_rect(col * 8 * scale + j * scale,
-                          row * 8 * scale + i * scale, scale, scale, color);
-            }
-        }
-    }
+    auto const& fb = kernel::frame_buffer;
+    auto const size = font::SIZE * scale;
+    font::glyph(kernel::fpu.avx2,
+                fb.pixels + u64(row * size) * fb.stride + col * size,
+                fb.stride, c, scale, color);
 }
 
 // Update print_string to pass the scale
@@ -161,6 +154,23 @@ auto __attribute__((noinline)) avx_mul_add_8(f32* const dst,
         : "ymm0", "ymm1", "ymm2", "memory");
 }
 
+// (5) avx-512 implementation (uses zmm registers for 16-wide floats)
+// note: zmm17 exercises the upper 16 registers saved as hi16_zmm state
+[[gnu::target("avx512f")]] auto __attribute__((noinline))
+avx512_mul_add_16(f32* const dst, f32 const* const src, f32 const* const mulv,
+                  f32 const* const addv) -> void {
+    asm volatile(
+        "vmovaps  (%[src]), %%zmm0  \n"
+        "vmovaps  (%[mul]), %%zmm17 \n"
+        "vmovaps  (%[add]), %%zmm2  \n"
+        "vmulps   %%zmm17, %%zmm0, %%zmm0 \n"
+        "vaddps   %%zmm2, %%zmm0, %%zmm0 \n"
+        "vmovaps  %%zmm0, (%[dst])  \n"
+        :
+        : [src] "r"(src), [dst] "r"(dst), [mul] "r"(mulv), [add] "r"(addv)
+        : "zmm0", "zmm17", "zmm2", "memory");
+}
+
 // triggers red screen panic if calculation is incorrect
 auto assert_simd(bool const condition, char const* const msg) -> void {
     if (!condition) {
@@ -197,47 +207,1961 @@ auto test_simd_support() -> void {
     avx_mul_add_8(dst, src, mul, add);
     assert_simd(dst[7] == 14.0f, "avx ymm check"); // 8.0 * 1.5 + 2.0
     kernel::serial::print("ok\n");
+
+    if (kernel::fpu.avx512) {
+        alignas(64) f32 src16[16];
+        alignas(64) f32 dst16[16];
+        alignas(64) f32 mul16[16];
+        alignas(64) f32 add16[16];
+        for (auto i = 0u; i < 16; ++i) {
+            src16[i] = f32(i + 1);
+            mul16[i] = 1.5f;
+            add16[i] = 2.0f;
+        }
+
+        kernel::serial::print("testing avx-512... ");
+        avx512_mul_add_16(dst16, src16, mul16, add16);
+        // 16.0 * 1.5 + 2.0
+        assert_simd(dst16[15] == 26.0f, "avx-512 zmm check");
+        kernel::serial::print("ok\n");
+    }
 }
 
-} // namespace
+// copies whole cache lines with avx non-temporal stores without fencing
+// note: `dest` is 32 byte aligned and `n` is a multiple of 64; callers fence
+//       with `sfence`
+auto memcpy_nt_lines_avx(void* const dest, void const* const src, u64 const n)
+    -> void {
+    auto* const d = ptr<u8>(dest);
+    auto const* const s = ptr<u8 const>(src);
+    for (auto i = 0ull; i < n; i += 64) {
+        asm volatile("vmovdqu    (%[src]), %%ymm0 \n"
+                     "vmovdqu  32(%[src]), %%ymm1 \n"
+                     "vmovntdq %%ymm0,   (%[dst]) \n"
+                     "vmovntdq %%ymm1, 32(%[dst]) \n"
+                     :
+                     : [src] "r"(s + i), [dst] "r"(d + i)
+                     : "ymm0", "ymm1", "memory");
+    }
+    // avoid sse transition penalties after the upper halves were written
+    asm volatile("vzeroupper" : : : "memory");
+}
 
-namespace osca {
+// back buffer tiles changed since the last present; set by the jobs drawing
+// them and cleared by `present`
+class DirtyTiles {
+  public:
+    // 4 cache lines of pixels wide
+    auto constexpr static TILE_WIDTH = 64u;
+    auto constexpr static TILE_HEIGHT = 16u;
 
-class Printer {
-    kernel::FrameBuffer fb_;
-    u32 row_ = 0;
-    u32 col_ = 0;
-    u32 color_ = 0xff'ff'ff'ff;
-    u32 scale_ = 1;
-    u32 defcol_ = 0;
+    // e.g. 3840 x 2160 is 60 x 135 tiles
+    auto constexpr static MAX_TILES = 256u * 64;
+
+  private:
+    u64 bits_[MAX_TILES / 64]{};
+    u32 columns_ = 0;
+    u32 rows_ = 0;
 
-    auto drwchr(char c) -> void {
+  public:
+    auto init(u32 const width, u32 const height) -> void {
+        columns_ = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+        rows_ = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+        if (columns_ * rows_ > MAX_TILES) {
+            kernel::serial::print("frame buffer has too many tiles\n");
+            kernel::panic(0x00ff00ff); // magenta
+        }
+        mark_all();
+    }
 
-        auto fb = fb_.pixels;
-        auto stride = fb_.stride;
-        if (c < 32 || c > 126) {
-            c = '?';
+    // marks the tiles overlapping pixels (x0, y0) to (x1, y1) exclusive
+    // note: call after drawing; release publishes the pixels to `present`
+    auto mark(u32 const x0, u32 const y0, u32 const x1, u32 const y1)
+        -> void {
+        if (x1 <= x0 || y1 <= y0) {
+            return;
         }
-        auto glyph = ASCII_FONT[u8(c)];
-        for (auto i = 0u; i < 8; ++i) {
-            for (auto j = 0u; j < 8; ++j) {
-                if (glyph[i] & (1 << (7 - j))) {
-                    drwrct(col_ * 8 * scale_ + j * scale_,
-                           row_ * 8 * scale_ + i * scale_, scale_, scale_,
-                           color_);
+        auto const tx0 = x0 / TILE_WIDTH;
+        auto const tx1 = (x1 - 1) / TILE_WIDTH;
+        auto const ty0 = y0 / TILE_HEIGHT;
+        auto const ty1 = (y1 - 1) / TILE_HEIGHT < rows_
+                             ? (y1 - 1) / TILE_HEIGHT
+                             : rows_ - 1;
+        for (auto ty = ty0; ty <= ty1; ++ty) {
+            // one atomic per word of the tile row
+            auto word = ~0u;
+            auto bits = 0ull;
+            for (auto tx = tx0; tx <= tx1 && tx < columns_; ++tx) {
+                auto const i = ty * columns_ + tx;
+                if (i / 64 != word) {
+                    if (bits) {
+                        // (1) paired with acquire (2)
+                        atomic::bit_or(&bits_[word], bits, atomic::RELEASE);
+                    }
+                    word = i / 64;
+                    bits = 0;
                 }
+                bits |= 1ull << (i % 64);
+            }
+            if (bits) {
+                // (1) paired with acquire (2)
+                atomic::bit_or(&bits_[word], bits, atomic::RELEASE);
             }
         }
     }
 
-    auto drwrct(u32 const x, u32 const y, u32 const width, u32 const height,
-                u32 const color) -> void {
+    auto mark_all() -> void {
+        for (auto i = 0u; i < columns_ * rows_; ++i) {
+            atomic::bit_or(&bits_[i / 64], 1ull << (i % 64), atomic::RELAXED);
+        }
+    }
 
-        for (auto i = y; i < y + height; ++i) {
-            for (auto j = x; j < x + width; ++j) {
-                fb_.pixels[i * kernel::frame_buffer.stride + j] = color;
+    // copies the dirty tiles of `back` to `front` in whole cache lines with
+    // non-temporal stores into the write-combining frame buffer as
+    // `job_count` priority jobs of tile row bands and waits for them
+    // returns bytes copied
+    // note: `back` and `front` have the same size and stride
+    auto present(kernel::FrameBuffer const& back,
+                 kernel::FrameBuffer const& front, u32 job_count) -> u64;
+
+    // copies and clears the dirty tiles in tile rows `row_start` to
+    // `row_end`; stores are fenced on return
+    // returns bytes copied
+    auto present_rows(kernel::FrameBuffer const& back,
+                      kernel::FrameBuffer const& front, u32 const row_start,
+                      u32 const row_end) -> u64 {
+        auto const total = u64(back.height) * back.stride * sizeof(u32);
+        auto* const dst = ptr<u8>(front.pixels);
+        auto const* const src = ptr<u8 const>(back.pixels);
+        // note: the frame buffer is page aligned in practice
+        auto const avx = uptr(dst) % 32 == 0;
+
+        auto const first = row_start * columns_;
+        auto const last = row_end * columns_;
+
+        auto bytes = 0ull;
+        for (auto w = first / 64; w < (last + 63) / 64; ++w) {
+            // only the band's bits; neighbouring bands share boundary words
+            auto const lo = w * 64 < first ? first - w * 64 : 0u;
+            auto const hi = w * 64 + 64 > last ? last - w * 64 : 64u;
+            auto const mask =
+                (hi == 64 ? ~0ull : (1ull << hi) - 1) & ~((1ull << lo) - 1);
+
+            // (2) paired with release (1)
+            auto bits =
+                atomic::bit_and(&bits_[w], ~mask, atomic::ACQUIRE) & mask;
+            while (bits) {
+                auto const i = w * 64 + u32(__builtin_ctzll(bits));
+                bits &= bits - 1;
+
+                auto const x0 = i % columns_ * TILE_WIDTH;
+                auto const x1 = x0 + TILE_WIDTH < back.width
+                                    ? x0 + TILE_WIDTH
+                                    : back.width;
+                auto const y0 = i / columns_ * TILE_HEIGHT;
+                auto const y1 = y0 + TILE_HEIGHT < back.height
+                                    ? y0 + TILE_HEIGHT
+                                    : back.height;
+
+                for (auto y = y0; y < y1; ++y) {
+                    // widen to cache lines; both buffers share the layout
+                    auto const row = u64(y) * back.stride;
+                    auto const start = (row + x0) * sizeof(u32) & ~63ull;
+                    auto end = ((row + x1) * sizeof(u32) + 63) & ~63ull;
+                    if (end > total) {
+                        end = total;
+                    }
+                    if (avx) {
+                        memcpy_nt_lines_avx(dst + start, src + start,
+                                            end - start);
+                    } else {
+                        kernel::memcpy_nt_lines(dst + start, src + start,
+                                                end - start);
+                    }
+                    bytes += end - start;
+                }
             }
         }
+        asm volatile("sfence" : : : "memory");
+        return bytes;
+    }
+
+    auto rows() const -> u32 { return rows_; }
+};
+
+// tile rows `row_start` to `row_end` of `tiles`
+struct PresentJob {
+    DirtyTiles* tiles;
+    kernel::FrameBuffer const* back;
+    kernel::FrameBuffer const* front;
+    u64* bytes;
+    u32* remaining;
+    u32 row_start;
+    u32 row_end;
+
+    auto run() -> void {
+        auto const n = tiles->present_rows(*back, *front, row_start, row_end);
+        atomic::add(bytes, n, atomic::RELAXED);
+        // (1) paired with acquire (2)
+        atomic::sub(remaining, 1u, atomic::RELEASE);
+    }
+};
+
+auto DirtyTiles::present(kernel::FrameBuffer const& back,
+                         kernel::FrameBuffer const& front, u32 const job_count)
+    -> u64 {
+    auto bytes = 0ull;
+    auto remaining = 0u;
+    auto const dy = rows_ / job_count;
+    auto row = 0u;
+    for (auto i = 0u; i < job_count; ++i) {
+        auto const row_end = (i == job_count - 1) ? rows_ : row + dy;
+        if (row_end > row) {
+            atomic::add(&remaining, 1u, atomic::RELAXED);
+            osca::priority_jobs.add<PresentJob>(this, &back, &front, &bytes,
+                                                &remaining, row, row_end);
+        }
+        row = row_end;
+    }
+    // note: waits only for these jobs; render jobs of the next frame may be
+    //       queued or running
+    // (2) paired with release (1)
+    while (atomic::load(&remaining, atomic::ACQUIRE) != 0) {
+        kernel::core::pause();
+    }
+    return bytes;
+}
+
+// frame buffer sized memory rendered to off screen, then presented
+// note: render jobs mark the tiles they draw and then decrement `pending`;
+//       the frame is complete when it is 0
+struct BackBuffer {
+    kernel::FrameBuffer fb;
+    DirtyTiles dirty;
+    u32 pending;
+    // temporary memory of the frame's jobs; see `frame_arenas`
+    kernel::memory::FrameArena* arena;
+
+    // allocates memory of `front`'s size and layout and clears it
+    auto init(kernel::FrameBuffer const& front,
+              kernel::memory::FrameArena& frame_arena) -> void {
+        auto const bytes = u64(front.height) * front.stride * sizeof(u32);
+        auto const pages = (bytes + 4095) / 4096;
+        fb = front;
+        fb.pixels = ptr<u32>(kernel::allocate_pages_uninit(pages));
+        osca::parallel_memset(fb.pixels, 0, pages * 4096);
+        dirty.init(fb.width, fb.height);
+        pending = 0;
+        arena = &frame_arena;
+    }
+
+    // a render job of the frame is finished
+    auto done() -> void {
+        // (1) paired with acquire (2)
+        atomic::sub(&pending, 1u, atomic::RELEASE);
+    }
+
+    // waits for the render jobs of the frame
+    auto wait() const -> void {
+        // (2) paired with release (1)
+        while (atomic::load(&pending, atomic::ACQUIRE) != 0) {
+            kernel::core::pause();
+        }
+    }
+};
+
+// escape-time kernel of `FractalJob`; widest supported, set in `start`
+auto fractal_simd = fractal::Simd::SCALAR;
+
+// how `render_frame` splits the work
+//  * scan: horizontal bands computing every pixel with `fractal_simd`
+//  * subdivide: tiles filled from their border when uniform (mariani-silver)
+//  * reuse: bands warping the previous frame's iterations to the new view
+//  * deep: bands iterating f64 differences to a reference orbit
+//  * progressive: coarse to full resolution passes presented one by one
+enum class FractalMode : u8 { SCAN, SUBDIVIDE, REUSE, DEEP, PROGRESSIVE };
+
+auto constexpr FRACTAL_MODE_COUNT = 5u;
+
+auto fractal_mode_name(FractalMode const mode) -> char const* {
+    switch (mode) {
+    case FractalMode::SCAN:
+        return "scan";
+    case FractalMode::SUBDIVIDE:
+        return "subdivide";
+    case FractalMode::REUSE:
+        return "reuse";
+    case FractalMode::DEEP:
+        return "deep";
+    case FractalMode::PROGRESSIVE:
+        return "progressive";
+    }
+    return "";
+}
+
+// key 'm' presses; cycles through `FractalMode`
+u32 fractal_mode_toggles;
+
+// key 'z' presses; odd zooms in one step every frame
+u32 fractal_zoom_toggles;
+
+// key 'c' presses; odd shows `text_console` instead of the fractal
+u32 console_toggles;
+
+// `console::log` below the status line
+console::Console text_console;
+
+// pixel rows of the status line band at the top of the screen
+auto constexpr STATUS_HEIGHT = 3u * 8 * 2;
+
+// black inside the set
+auto fractal_color(u32 const iterations, u32 const frame,
+                   u32 const max_iterations = fractal::MAX_ITERATIONS) -> u32 {
+    if (iterations >= max_iterations) {
+        return 0;
+    }
+    // dynamic coloring: blue shifts based on zoom/frame
+    auto const blue = (iterations * 255u / max_iterations) & 0xffu;
+    auto const red = (frame / 2u) & 0xffu;
+    return (red << 16u) | (blue << 8u) | 255u;
+}
+
+// renders the mandelbrot set in rows `y_start` to `y_end`
+struct FractalJob {
+    BackBuffer* target;
+    u32 y_start;
+    u32 y_end;
+    u32 frame; // use frame for zoom level
+
+    auto run() -> void {
+        auto const& fb = target->fb;
+        auto const width = fb.width;
+        auto const stride = fb.stride;
+        auto* pixels = fb.pixels;
+
+        auto const view = fractal::view(width, fb.height, frame);
+
+        u32 iterations[fractal::CHUNK];
+        for (auto y = y_start; y < y_end; ++y) {
+            for (auto x0 = 0u; x0 < width; x0 += fractal::CHUNK) {
+                auto const count = width - x0 < fractal::CHUNK
+                                       ? width - x0
+                                       : fractal::CHUNK;
+
+                fractal::row(fractal_simd, view, x0, y, count, iterations);
+
+                if constexpr (config::DEBUG) {
+                    u32 reference[fractal::CHUNK];
+                    fractal::row_scalar(view, x0, y, count, reference);
+                    for (auto i = 0u; i < count; ++i) {
+                        assert_simd(iterations[i] == reference[i],
+                                    "fractal kernel differs from scalar");
+                    }
+                }
+
+                for (auto i = 0u; i < count; ++i) {
+                    pixels[y * stride + x0 + i] =
+                        fractal_color(iterations[i], frame);
+                }
+            }
+        }
+        target->dirty.mark(0, y_start, width, y_end);
+        target->done();
+    }
+};
+
+// renders the tile with inclusive corners (x0, y0) and (x1, y1) by
+// mariani-silver subdivision
+// note: a tile whose border has one iteration count is filled without
+//       computing its inside; otherwise its two middle lines are computed and
+//       it is split in four tiles added as jobs, run inline when the queue is
+//       full; each adds to the target's pending jobs
+// note: children read their border, computed by the parent, back from the
+//       buffer; `fractal_color` is one to one within a frame so equal colors
+//       are equal iteration counts
+struct TileJob {
+    BackBuffer* target;
+    fractal::View view;
+    u32 frame;
+    u32 x0;
+    u32 y0;
+    u32 x1;
+    u32 y1;
+    // border already drawn by the parent tile
+    bool has_border;
+
+    // tiles at most this wide or high are computed per pixel
+    auto constexpr static MIN_SIZE = 8u;
+
+    // computes and draws `count` pixels from (x, y) along the row, or down the
+    // column if `vertical`
+    // note: the scalar fallback keeps the interior shortcuts of
+    //       `fractal::point`; the vector kernels do not need them
+    auto line(u32 const x, u32 const y, u32 const count,
+              bool const vertical) const -> void {
+        auto const simd = fractal_simd;
+        auto const& fb = target->fb;
+        auto const step = vertical ? u64(fb.stride) : 1ull;
+
+        u32 iterations[fractal::CHUNK];
+        for (auto i = 0u; i < count; i += fractal::CHUNK) {
+            auto const n =
+                count - i < fractal::CHUNK ? count - i : fractal::CHUNK;
+            auto const px = vertical ? x : x + i;
+            auto const py = vertical ? y + i : y;
+
+            if (simd == fractal::Simd::SCALAR) {
+                for (auto j = 0u; j < n; ++j) {
+                    iterations[j] = vertical ? fractal::point(view, px, py + j)
+                                             : fractal::point(view, px + j, py);
+                }
+            } else if (vertical) {
+                fractal::column(simd, view, px, py, n, iterations);
+            } else {
+                fractal::row(simd, view, px, py, n, iterations);
+            }
+
+            auto* const dst = fb.pixels + u64(py) * fb.stride + px;
+            for (auto j = 0u; j < n; ++j) {
+                dst[j * step] = fractal_color(iterations[j], frame);
+            }
+        }
+    }
+
+    auto split(u32 const ax, u32 const ay, u32 const bx, u32 const by) const
+        -> void {
+        auto const tile = TileJob{target, view, frame, ax, ay, bx, by, true};
+        // before this tile is done so the frame is never complete early
+        atomic::add(&target->pending, 1u, atomic::RELAXED);
+        if (!osca::jobs.try_add<TileJob>(tile)) {
+            TileJob{tile}.run();
+        }
+    }
+
+    auto run() -> void {
+        render();
+        target->dirty.mark(x0, y0, x1 + 1, y1 + 1);
+        target->done();
+    }
+
+    auto render() -> void {
+        auto const& fb = target->fb;
+
+        if (!has_border) {
+            line(x0, y0, x1 - x0 + 1, false);
+            line(x0, y1, x1 - x0 + 1, false);
+            line(x0, y0 + 1, y1 - y0 - 1, true);
+            line(x1, y0 + 1, y1 - y0 - 1, true);
+        }
+
+        if (x1 - x0 < 2 || y1 - y0 < 2) {
+            // border is the whole tile
+            return;
+        }
+
+        auto const* const top = fb.pixels + u64(y0) * fb.stride;
+        auto const* const bottom = fb.pixels + u64(y1) * fb.stride;
+        auto const first = top[x0];
+        auto uniform = true;
+        for (auto x = x0; x <= x1; ++x) {
+            uniform &= top[x] == first;
+            uniform &= bottom[x] == first;
+        }
+        for (auto y = y0 + 1; y < y1; ++y) {
+            auto const* const row = fb.pixels + u64(y) * fb.stride;
+            uniform &= row[x0] == first;
+            uniform &= row[x1] == first;
+        }
+
+        if (uniform) {
+            for (auto y = y0 + 1; y < y1; ++y) {
+                auto* const row = fb.pixels + u64(y) * fb.stride;
+                for (auto x = x0 + 1; x < x1; ++x) {
+                    row[x] = first;
+                }
+            }
+            return;
+        }
+
+        if (x1 - x0 <= MIN_SIZE || y1 - y0 <= MIN_SIZE) {
+            for (auto y = y0 + 1; y < y1; ++y) {
+                line(x0 + 1, y, x1 - x0 - 1, false);
+            }
+            return;
+        }
+
+        // quadrants share their middle lines; computed once here so every
+        // quadrant's border is known
+        auto const xm = (x0 + x1) / 2;
+        auto const ym = (y0 + y1) / 2;
+        line(x0 + 1, ym, x1 - x0 - 1, false);
+        line(xm, y0 + 1, ym - y0 - 1, true);
+        line(xm, ym + 1, y1 - ym - 1, true);
+        split(x0, y0, xm, ym);
+        split(xm, y0, x1, ym);
+        split(x0, ym, xm, y1);
+        split(xm, ym, x1, y1);
+    }
+};
+
+// iteration buffers of the previous and current frame for
+// `FractalMode::REUSE`
+//
+// each new column and row is matched with the nearest old one; an old one is
+// matched at most once, with the closest new one, so when zooming in by 0.95
+// about 5% of the columns and rows have no source and are computed
+//
+// a pixel whose column and row both have a source at the identical position
+// copies the old iterations with their `APPROX` flag; one whose source lies
+// between old samples copies the nearest one flagged `APPROX`, but only if
+// that one is exact, and is computed otherwise
+//
+// error: a shown pixel is exact or the exact iterations of a point at most
+// half an old sample away in each axis, never a copy of a copy; when zooming
+// about every other frame computes a pixel
+//
+// every frame the `APPROX` pixels of one row in `REFINE_INTERVAL` are
+// computed so a still view is exact after that many frames
+class FractalReuse {
+  public:
+    // iteration count flag of a pixel copied from a different position
+    auto constexpr static APPROX = 1u << 31;
+
+    auto constexpr static REFINE_INTERVAL = 8u;
+
+  private:
+    // old column or row per new one; -1 if none
+    struct Match {
+        i32 source;
+        bool exact;
+    };
+
+    u32* previous_ = nullptr;
+    u32* current_ = nullptr;
+    Match* columns_ = nullptr;
+    Match* rows_ = nullptr;
+    u32 width_ = 0;
+    u32 height_ = 0;
+    fractal::View view_{};
+    fractal::View previous_view_{};
+    bool previous_valid_ = false;
+    u32 pass_ = 0;
+    u32 frame_ = 0;
+    BackBuffer* target_ = nullptr;
+
+    // sample `i` of the new view is at `start + i * scale` in old samples
+    static auto match(f64 const start, f64 const scale, u32 const old_count,
+                      u32 const count, Match* const out) -> void {
+        auto last = -1;
+        auto last_i = 0u;
+        auto last_distance = 0.0;
+        for (auto i = 0u; i < count; ++i) {
+            auto const p = start + f64(i) * scale;
+            out[i] = {.source = -1, .exact = false};
+            if (p < -0.5 || p >= f64(old_count) - 0.5) {
+                continue;
+            }
+            auto const k = i32(p + 0.5);
+            auto const d = p - f64(k);
+            auto const distance = d < 0 ? -d : d;
+            if (k == last) {
+                // old sample claimed by the previous new one; keep closest
+                if (distance >= last_distance) {
+                    continue;
+                }
+                out[last_i] = {.source = -1, .exact = false};
+            }
+            out[i] = {.source = k, .exact = distance == 0.0};
+            last = k;
+            last_i = i;
+            last_distance = distance;
+        }
+    }
+
+    auto init(kernel::FrameBuffer const& fb) -> void {
+        auto const pixels = u64(fb.width) * fb.height;
+        auto const buffer_pages = (pixels * sizeof(u32) + 4095) / 4096;
+        auto const match_pages =
+            ((fb.width + fb.height) * sizeof(Match) + 4095) / 4096;
+        if (current_) {
+            kernel::free_pages(previous_, buffer_pages);
+            kernel::free_pages(current_, buffer_pages);
+            kernel::free_pages(columns_, match_pages);
+        }
+        previous_ = ptr<u32>(kernel::allocate_pages_uninit(buffer_pages));
+        current_ = ptr<u32>(kernel::allocate_pages_uninit(buffer_pages));
+        columns_ = ptr<Match>(kernel::allocate_pages_uninit(match_pages));
+        rows_ = columns_ + fb.width;
+        width_ = fb.width;
+        height_ = fb.height;
+        previous_valid_ = false;
+    }
+
+  public:
+    // renders `frame` in `job_count` bands and waits for the jobs to finish
+    auto render(BackBuffer& target, u32 job_count, u32 frame) -> void;
+
+    // copies pixel `x` of a row with source `row` from the old row `in` to
+    // `out`
+    // returns false if it has to be computed: no source, an approximate
+    // source for a position between old samples, or approximate in a
+    // refinement row
+    auto copy(u32 const* const in, Match const row, u32 const x,
+              bool const refine, u32& out) const -> bool {
+        auto const column = columns_[x];
+        if (column.source < 0) {
+            return false;
+        }
+        auto const n = in[column.source];
+        if (row.exact && column.exact) {
+            out = n;
+        } else if (!(n & APPROX)) {
+            out = n | APPROX;
+        } else {
+            return false;
+        }
+        return !(refine && (out & APPROX));
+    }
+
+    // computes and colors rows `y_start` to `y_end`
+    auto run_rows(u32 const y_start, u32 const y_end) const -> void {
+        auto const simd = fractal_simd;
+        auto const& fb = target_->fb;
+        for (auto y = y_start; y < y_end; ++y) {
+            auto* const out = current_ + u64(y) * width_;
+            auto const row = rows_[y];
+            auto const refine = y % REFINE_INTERVAL == pass_;
+
+            if (row.source < 0) {
+                for (auto x = 0u; x < width_; x += fractal::CHUNK) {
+                    auto const count = width_ - x < fractal::CHUNK
+                                           ? width_ - x
+                                           : fractal::CHUNK;
+                    fractal::row(simd, view_, x, y, count, out + x);
+                }
+            } else {
+                auto const* const in =
+                    previous_ + u64(row.source) * width_;
+                auto x = 0u;
+                while (x < width_) {
+                    if (copy(in, row, x, refine, out[x])) {
+                        ++x;
+                        continue;
+                    }
+
+                    // run of pixels to compute
+                    auto end = x + 1;
+                    while (end < width_ && end - x < fractal::CHUNK &&
+                           !copy(in, row, end, refine, out[end])) {
+                        ++end;
+                    }
+                    fractal::row(simd, view_, x, y, end - x, out + x);
+                    x = end;
+                }
+            }
+
+            auto* const pixels = fb.pixels + u64(y) * fb.stride;
+            for (auto x = 0u; x < width_; ++x) {
+                pixels[x] = fractal_color(out[x] & ~APPROX, frame_);
+            }
+        }
+        target_->dirty.mark(0, y_start, width_, y_end);
+    }
+};
+
+FractalReuse fractal_reuse;
+
+// rows of `fractal_reuse` for one frame
+struct FractalReuseJob {
+    FractalReuse const* reuse;
+    u32 y_start;
+    u32 y_end;
+
+    auto run() -> void { reuse->run_rows(y_start, y_end); }
+};
+
+auto FractalReuse::render(BackBuffer& target, u32 const job_count,
+                          u32 const frame) -> void {
+    auto const& fb = target.fb;
+    if (fb.width != width_ || fb.height != height_) {
+        init(fb);
+    }
+
+    target_ = &target;
+    frame_ = frame;
+    view_ = fractal::view(fb.width, fb.height, frame);
+
+    if (previous_valid_) {
+        auto const& a = previous_view_;
+        auto const& b = view_;
+        match((f64(b.min_re) - f64(a.min_re)) / f64(a.re_step),
+              f64(b.re_step) / f64(a.re_step), width_, width_, columns_);
+        // imaginary axis points down
+        match((f64(a.max_im) - f64(b.max_im)) / f64(a.im_step),
+              f64(b.im_step) / f64(a.im_step), height_, height_, rows_);
+    } else {
+        for (auto x = 0u; x < width_; ++x) {
+            columns_[x] = {.source = -1, .exact = false};
+        }
+        for (auto y = 0u; y < height_; ++y) {
+            rows_[y] = {.source = -1, .exact = false};
+        }
+    }
+
+    auto const dy = height_ / job_count;
+    auto y = 0u;
+    for (auto i = 0u; i < job_count; ++i) {
+        auto const y_end = (i == job_count - 1) ? height_ : y + dy;
+        osca::jobs.add<FractalReuseJob>(this, y, y_end);
+        y = y_end;
+    }
+    osca::jobs.wait_idle();
+
+    auto* const t = previous_;
+    previous_ = current_;
+    current_ = t;
+    previous_view_ = view_;
+    previous_valid_ = true;
+    pass_ = (pass_ + 1) % REFINE_INTERVAL;
+}
+
+// multi-resolution rendering of `FractalMode::PROGRESSIVE`
+//
+// passes sample every 8th, 4th, 2nd and finally every pixel; a pass computes
+// only samples that earlier passes did not and fills the block each sample
+// stands for, so the passes together compute every pixel once
+//
+// pass jobs are background jobs; a new view cancels the passes of the old
+// one, jobs seeing a newer generation stop at the next row and the new pass
+// is added once they stopped so no stale row is drawn over it
+class FractalProgressive {
+  public:
+    auto constexpr static PASSES = 4u;
+
+  private:
+    // generation in the high half, unfinished jobs of the pass in the low
+    // half
+    u64 state_ = 0;
+
+    // added jobs not yet finished of any generation, cancelled or not
+    u32 running_ = 0;
+
+    BackBuffer* target_ = nullptr;
+    u32 frame_ = 0;
+    u32 pass_ = 0;
+    u32 job_count_ = 1;
+    bool started_ = false;
+
+    // cancels the jobs of the current generation and waits for them to stop;
+    // a job cancelled in the middle of a row still finishes the row
+    // `pending` jobs of the new generation are about to be added
+    // returns the new generation
+    // note: queued jobs of older generations return without drawing
+    auto stop_jobs(u32 const pending) -> u32 {
+        auto const generation =
+            u32(atomic::load(&state_, atomic::RELAXED) >> 32) + 1;
+        atomic::store(&state_, u64(generation) << 32 | pending,
+                      atomic::RELEASE);
+
+        // (4) paired with release (3)
+        while (atomic::load(&running_, atomic::ACQUIRE) != 0) {
+            kernel::core::pause();
+        }
+        atomic::store(&running_, pending, atomic::RELAXED);
+        return generation;
+    }
+
+    auto start_pass() -> void;
+
+  public:
+    // starts rendering `frame` in `job_count` bands per pass unless it is the
+    // frame being rendered; cancels the passes of the previous one
+    auto show(BackBuffer& target, u32 const job_count, u32 const frame)
+        -> void {
+        if (started_ && target_ == &target && frame_ == frame) {
+            return;
+        }
+        target_ = &target;
+        frame_ = frame;
+        job_count_ = job_count;
+        pass_ = 0;
+        started_ = true;
+        start_pass();
+    }
+
+    // stops rendering, e.g. before something else draws into the target;
+    // the next `show` starts over
+    auto cancel() -> void {
+        stop_jobs(0);
+        started_ = false;
+    }
+
+    // true when the current pass is finished
+    auto pass_done() const -> bool {
+        // (1) paired with release (2)
+        // note: acquire makes the pass's pixels visible
+        return u32(atomic::load(&state_, atomic::ACQUIRE)) == 0;
+    }
+
+    // true when the last pass is finished
+    auto complete() const -> bool {
+        return pass_ == PASSES - 1 && pass_done();
+    }
+
+    // starts the next pass once the current one is finished
+    // returns false if there is none or the current one is not finished
+    auto next_pass() -> bool {
+        if (pass_ + 1 >= PASSES || !pass_done()) {
+            return false;
+        }
+        ++pass_;
+        start_pass();
+        return true;
+    }
+
+    auto generation() const -> u32 {
+        return u32(atomic::load(&state_, atomic::RELAXED) >> 32);
+    }
+
+    // computes the samples of `pass` in rows `y_start` to `y_end`
+    static auto run_rows(BackBuffer& target, fractal::View const& view,
+                         u32 generation, u32 frame, u32 pass, u32 y_start,
+                         u32 y_end) -> void;
+
+    // marks a job of `generation` finished; counts for the pass unless it
+    // was cancelled
+    auto finish(u32 const generation) -> void {
+        auto s = atomic::load(&state_, atomic::RELAXED);
+        while (u32(s >> 32) == generation) {
+            // (2) paired with acquire (1)
+            if (atomic::compare_exchange(&state_, &s, s - 1, true,
+                                         atomic::RELEASE, atomic::RELAXED)) {
+                break;
+            }
+        }
+        // (3) paired with acquire (4)
+        atomic::sub(&running_, 1u, atomic::RELEASE);
+    }
+};
+
+FractalProgressive fractal_progressive;
+
+// rows of one `fractal_progressive` pass
+struct FractalProgressiveJob {
+    BackBuffer* target;
+    fractal::View view;
+    u32 generation;
+    u32 frame;
+    u32 pass;
+    u32 y_start;
+    u32 y_end;
+
+    auto run() -> void {
+        FractalProgressive::run_rows(*target, view, generation, frame, pass,
+                                     y_start, y_end);
+        fractal_progressive.finish(generation);
+    }
+};
+
+auto FractalProgressive::start_pass() -> void {
+    auto const& fb = target_->fb;
+    auto const view = fractal::view(fb.width, fb.height, frame_);
+
+    auto const generation = stop_jobs(job_count_);
+
+    auto const dy = fb.height / job_count_;
+    auto y = 0u;
+    for (auto i = 0u; i < job_count_; ++i) {
+        auto const y_end = (i == job_count_ - 1) ? fb.height : y + dy;
+        osca::background_jobs.add<FractalProgressiveJob>(
+            target_, view, generation, frame_, pass_, y, y_end);
+        y = y_end;
+    }
+}
+
+auto FractalProgressive::run_rows(BackBuffer& target,
+                                  fractal::View const& view,
+                                  u32 const generation, u32 const frame,
+                                  u32 const pass, u32 const y_start,
+                                  u32 const y_end) -> void {
+    auto const& fb = target.fb;
+    // block size 8, 4, 2, 1
+    auto const size = 8u >> pass;
+    auto const simd = fractal_simd;
+
+    u32 iterations[fractal::CHUNK];
+    for (auto y = (y_start + size - 1) / size * size; y < y_end; y += size) {
+        if (fractal_progressive.generation() != generation) {
+            // cancelled by a newer view
+            return;
+        }
+
+        // rows on the previous pass's grid already have its samples
+        auto const has_previous = pass > 0 && y % (size * 2) == 0;
+        auto const x_first = has_previous ? size : 0u;
+        auto const x_stride = has_previous ? size * 2 : size;
+        auto const block_h = fb.height - y < size ? fb.height - y : size;
+
+        for (auto x0 = x_first; x0 < fb.width;
+             x0 += x_stride * fractal::CHUNK) {
+            auto const remaining = (fb.width - x0 + x_stride - 1) / x_stride;
+            auto const count =
+                remaining < fractal::CHUNK ? remaining : fractal::CHUNK;
+
+            fractal::row(simd, view, x0, y, count, iterations, x_stride);
+
+            for (auto i = 0u; i < count; ++i) {
+                auto const x = x0 + i * x_stride;
+                auto const color = fractal_color(iterations[i], frame);
+                auto const block_w = fb.width - x < size ? fb.width - x : size;
+                for (auto by = 0u; by < block_h; ++by) {
+                    auto* const row = fb.pixels + u64(y + by) * fb.stride + x;
+                    for (auto bx = 0u; bx < block_w; ++bx) {
+                        row[bx] = color;
+                    }
+                }
+            }
+        }
+        target.dirty.mark(0, y, fb.width, y + block_h);
+    }
+}
+
+// reference orbit of `FractalMode::DEEP`; one per frame
+fractal::Orbit fractal_orbit;
+
+// computes `fractal_orbit` for the frame
+struct FractalOrbitJob {
+    fractal::DeepView const* view;
+
+    auto run() -> void { fractal::reference_orbit(*view, fractal_orbit); }
+};
+
+// renders rows `y_start` to `y_end` against `fractal_orbit`
+struct FractalDeepJob {
+    BackBuffer* target;
+    fractal::DeepView const* view;
+    u32 y_start;
+    u32 y_end;
+    u32 frame;
+
+    auto run() -> void {
+        auto const simd = fractal_simd;
+        auto const& fb = target->fb;
+        auto const width = fb.width;
+        auto const max_iterations = view->max_iterations;
+
+        u32 iterations[fractal::CHUNK];
+        for (auto y = y_start; y < y_end; ++y) {
+            auto* const row = fb.pixels + u64(y) * fb.stride;
+            for (auto x0 = 0u; x0 < width; x0 += fractal::CHUNK) {
+                auto const count = width - x0 < fractal::CHUNK
+                                       ? width - x0
+                                       : fractal::CHUNK;
+
+                fractal::deep_row(simd, *view, fractal_orbit, x0, y, count,
+                                  iterations);
+
+                if constexpr (config::DEBUG) {
+                    u32 reference[fractal::CHUNK];
+                    fractal::deep_row_scalar(*view, fractal_orbit, x0, y,
+                                             count, reference);
+                    for (auto i = 0u; i < count; ++i) {
+                        assert_simd(iterations[i] == reference[i],
+                                    "deep fractal kernel differs from scalar");
+                    }
+                }
+
+                for (auto i = 0u; i < count; ++i) {
+                    row[x0 + i] =
+                        fractal_color(iterations[i], frame, max_iterations);
+                }
+            }
+        }
+        target->dirty.mark(0, y_start, width, y_end);
+    }
+};
+
+// true if frames of `mode` render while the previous one is presented
+// note: reuse and progressive build on the previous frame in the same
+//       buffer; deep shares one reference orbit
+auto is_pipelined(FractalMode const mode) -> bool {
+    return mode == FractalMode::SCAN || mode == FractalMode::SUBDIVIDE;
+}
+
+// starts rendering one frame to `target`; `BackBuffer::wait` waits for it
+//  * scan: `job_count` horizontal bands
+//  * subdivide: top level tiles of `TILE_SIZE` that subdivide further
+//  * reuse: `job_count` horizontal bands through `fractal_reuse`
+//  * deep: the reference orbit as one job, then `job_count` horizontal bands
+//  * progressive: all passes of `fractal_progressive`
+// note: returns once the jobs are added if `is_pipelined(mode)`, otherwise
+//       when the frame is rendered
+auto dispatch_frame(BackBuffer& target, u32 const job_count, u32 const frame,
+                    FractalMode const mode = FractalMode::SCAN) -> void {
+    auto const& fb = target.fb;
+
+    if (mode == FractalMode::PROGRESSIVE) {
+        fractal_progressive.show(target, job_count, frame);
+        do {
+            while (!fractal_progressive.pass_done()) {
+                kernel::core::pause();
+            }
+        } while (fractal_progressive.next_pass());
+        return;
+    }
+
+    if (mode == FractalMode::DEEP) {
+        auto const view = fractal::deep_view(fb.width, fb.height, frame);
+
+        osca::jobs.add<FractalOrbitJob>(&view);
+        osca::jobs.wait_idle();
+
+        auto const dy = fb.height / job_count;
+        auto y = 0u;
+        for (auto i = 0u; i < job_count; ++i) {
+            auto const y_end = (i == job_count - 1) ? fb.height : y + dy;
+            osca::jobs.add<FractalDeepJob>(&target, &view, y, y_end, frame);
+            y = y_end;
+        }
+        osca::jobs.wait_idle();
+        return;
+    }
+
+    if (mode == FractalMode::REUSE) {
+        fractal_reuse.render(target, job_count, frame);
+        return;
+    }
+
+    if (mode == FractalMode::SUBDIVIDE) {
+        auto constexpr TILE_SIZE = 128u;
+        auto const view = fractal::view(fb.width, fb.height, frame);
+        // neighbouring tiles share their edge
+        for (auto y = 0u; y + 1 < fb.height; y += TILE_SIZE) {
+            auto const y1 = y + TILE_SIZE < fb.height ? y + TILE_SIZE
+                                                      : fb.height - 1;
+            for (auto x = 0u; x + 1 < fb.width; x += TILE_SIZE) {
+                auto const x1 = x + TILE_SIZE < fb.width ? x + TILE_SIZE
+                                                         : fb.width - 1;
+                atomic::add(&target.pending, 1u, atomic::RELAXED);
+                osca::jobs.add<TileJob>(&target, view, frame, x, y, x1, y1,
+                                        false);
+            }
+        }
+        return;
+    }
+
+    auto const dy = fb.height / job_count;
+    auto y = 0u;
+    for (auto i = 0u; i < job_count; ++i) {
+        // if height isn't perfectly divisible, the last core takes the
+        // remainder
+        auto const y_end = (i == job_count - 1) ? fb.height : y + dy;
+
+        atomic::add(&target.pending, 1u, atomic::RELAXED);
+        osca::jobs.add<FractalJob>(&target, y, y_end, frame);
+
+        y = y_end;
+    }
+}
+
+// renders one frame and waits for the jobs to finish
+auto render_frame(BackBuffer& target, u32 const job_count, u32 const frame,
+                  FractalMode const mode = FractalMode::SCAN) -> void {
+    dispatch_frame(target, job_count, frame, mode);
+    target.wait();
+}
+
+// acknowledged ipis; incremented by `osca::on_ipi` on the receiving core
+u32 ipi_acks;
+
+// one json object per line on serial
+// note: scripts running `BENCHMARK=1 ./run.sh` pick lines starting with '{'
+class JsonLine {
+    bool first_ = true;
+
+    auto key(char const* const k) -> void {
+        kernel::serial::print(first_ ? "{\"" : ",\"");
+        first_ = false;
+        kernel::serial::print(k);
+        kernel::serial::print("\":");
+    }
+
+  public:
+    auto p(char const* const k, char const* const val) -> JsonLine& {
+        key(k);
+        kernel::serial::print("\"");
+        kernel::serial::print(val);
+        kernel::serial::print("\"");
+        return *this;
+    }
+
+    auto p(char const* const k, u64 const val) -> JsonLine& {
+        key(k);
+        kernel::serial::print_dec(val);
+        return *this;
+    }
+
+    // `val` thousandths as a decimal number, e.g. 12345 as 12.345
+    auto p_milli(char const* const k, u64 const val) -> JsonLine& {
+        key(k);
+        kernel::serial::print_dec(val / 1000);
+        kernel::serial::print(".");
+        auto const fraction = val % 1000;
+        for (auto digit = 100u; digit > 1 && fraction < digit; digit /= 10) {
+            kernel::serial::print("0");
+        }
+        kernel::serial::print_dec(fraction);
+        return *this;
+    }
+
+    auto end() -> void { kernel::serial::print("}\n"); }
+};
+
+// throughput of empty jobs through the shared queue
+auto bench_queue() -> void {
+    struct NopJob {
+        auto run() -> void {}
+    };
+
+    auto const count = config::BENCHMARK_QUEUE_JOBS;
+
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < count; ++i) {
+        osca::jobs.add<NopJob>();
+    }
+    osca::jobs.wait_idle();
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    JsonLine{}
+        .p("bench", "queue")
+        .p("jobs", count)
+        .p("ns", ns)
+        .p("jobs_per_sec", u64(count) * 1'000'000'000 / ns)
+        .end();
+}
+
+// frames per second of the fractal per supported kernel at increasing job
+// counts, with subdivision, while zooming with and without reuse and deep in
+// the zoom with and without perturbation, and progressively
+auto bench_fractal(BackBuffer& back) -> void {
+    auto const frames = config::BENCHMARK_FRACTAL_FRAMES;
+    auto const selected = fractal_simd;
+
+    fractal::Simd constexpr kernels[]{
+        fractal::Simd::SCALAR,
+        fractal::Simd::AVX2,
+        fractal::Simd::AVX512,
+    };
+
+    for (auto const simd : kernels) {
+        if (u8(simd) > u8(selected)) {
+            break;
+        }
+        fractal_simd = simd;
+
+        for (auto job_count = 1u; job_count <= 32; job_count *= 2) {
+            auto const t0 = kernel::core::read_tsc();
+            for (auto i = 0u; i < frames; ++i) {
+                render_frame(back, job_count, 0);
+            }
+            auto const ns =
+                kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+            JsonLine{}
+                .p("bench", "fractal")
+                .p("mode", "scan")
+                .p("simd", fractal::simd_name(simd))
+                .p("jobs", job_count)
+                .p("frames", frames)
+                .p("ns_per_frame", ns / frames)
+                .p("fps", u64(frames) * 1'000'000'000 / ns)
+                .end();
+        }
+    }
+
+    fractal_simd = selected;
+
+    // tiles are jobs so the job count does not apply
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < frames; ++i) {
+        render_frame(back, 0, 0, FractalMode::SUBDIVIDE);
+    }
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    JsonLine{}
+        .p("bench", "fractal")
+        .p("mode", "subdivide")
+        .p("simd", fractal::simd_name(fractal_simd))
+        .p("frames", frames)
+        .p("ns_per_frame", ns / frames)
+        .p("fps", u64(frames) * 1'000'000'000 / ns)
+        .end();
+    // zooming one step per frame from the first frame of the zoom
+    auto const zoom_frames = config::BENCHMARK_FRACTAL_ZOOM_FRAMES;
+    FractalMode constexpr zoom_modes[]{FractalMode::SCAN, FractalMode::REUSE};
+    for (auto const mode : zoom_modes) {
+        auto const z0 = kernel::core::read_tsc();
+        for (auto i = 0u; i < zoom_frames; ++i) {
+            render_frame(back, 32, i, mode);
+        }
+        auto const zoom_ns =
+            kernel::core::tsc_to_ns(kernel::core::read_tsc() - z0);
+
+        JsonLine{}
+            .p("bench", "fractal_zoom")
+            .p("mode", fractal_mode_name(mode))
+            .p("simd", fractal::simd_name(fractal_simd))
+            .p("frames", zoom_frames)
+            .p("ns_per_frame", zoom_ns / zoom_frames)
+            .p("fps", u64(zoom_frames) * 1'000'000'000 / zoom_ns)
+            .end();
+    }
+    // past the f32 precision of the scan kernels
+    auto const deep_frame = config::BENCHMARK_FRACTAL_DEEP_FRAME;
+    FractalMode constexpr deep_modes[]{FractalMode::SCAN, FractalMode::DEEP};
+    for (auto const mode : deep_modes) {
+        auto const d0 = kernel::core::read_tsc();
+        for (auto i = 0u; i < frames; ++i) {
+            render_frame(back, 32, deep_frame + i, mode);
+        }
+        auto const deep_ns =
+            kernel::core::tsc_to_ns(kernel::core::read_tsc() - d0);
+
+        JsonLine{}
+            .p("bench", "fractal_deep")
+            .p("mode", fractal_mode_name(mode))
+            .p("zoom_step", deep_frame)
+            .p("frames", frames)
+            .p("ns_per_frame", deep_ns / frames)
+            .p("fps", u64(frames) * 1'000'000'000 / deep_ns)
+            .end();
+    }
+
+    // time to the first pass and to full resolution of a new view
+    auto first_ns = 0ull;
+    auto complete_ns = 0ull;
+    for (auto i = 0u; i < frames; ++i) {
+        auto const p0 = kernel::core::read_tsc();
+        fractal_progressive.show(back, 32, i + 1);
+        while (!fractal_progressive.pass_done()) {
+            kernel::core::pause();
+        }
+        first_ns += kernel::core::tsc_to_ns(kernel::core::read_tsc() - p0);
+        render_frame(back, 32, i + 1, FractalMode::PROGRESSIVE);
+        complete_ns += kernel::core::tsc_to_ns(kernel::core::read_tsc() - p0);
+    }
+
+    JsonLine{}
+        .p("bench", "fractal_progressive")
+        .p("simd", fractal::simd_name(fractal_simd))
+        .p("frames", frames)
+        .p("first_pass_ns", first_ns / frames)
+        .p("complete_ns", complete_ns / frames)
+        .end();
+}
+
+// presenting the back buffer to the frame buffer: single core full frame
+// `memcpy`, all tiles dirty on 1, 2, 4, ... cores up to every core but the
+// waiting one and only the status line dirty
+// note: one present job per core; the calling core only waits
+auto bench_present(BackBuffer& back) -> void {
+    auto const frames = config::BENCHMARK_FRACTAL_FRAMES;
+    auto const& fb = back.fb;
+    auto const& front = kernel::frame_buffer;
+    auto const bytes = u64(fb.height) * fb.stride * sizeof(u32);
+
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < frames; ++i) {
+        memcpy(front.pixels, fb.pixels, bytes);
+    }
+    auto const memcpy_ns =
+        kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    // note: bytes per ns are gb per second
+    JsonLine{}
+        .p("bench", "present")
+        .p("dirty", "memcpy")
+        .p("cores", 1)
+        .p("bytes_per_frame", bytes)
+        .p("ns_per_frame", memcpy_ns / frames)
+        .p_milli("gb_per_sec", u64(frames) * bytes * 1'000 / memcpy_ns)
+        .end();
+
+    // all tiles dirty
+    auto const max_cores =
+        kernel::core_count > 1 ? kernel::core_count - 1 : 1u;
+    auto cores = 1u;
+    while (true) {
+        auto presented = 0ull;
+        auto const t1 = kernel::core::read_tsc();
+        for (auto i = 0u; i < frames; ++i) {
+            back.dirty.mark_all();
+            presented += back.dirty.present(fb, front, cores);
+        }
+        auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t1);
+
+        JsonLine{}
+            .p("bench", "present")
+            .p("dirty", "all")
+            .p("cores", cores)
+            .p("bytes_per_frame", presented / frames)
+            .p("ns_per_frame", ns / frames)
+            .p_milli("gb_per_sec", presented * 1'000 / ns)
+            .end();
+
+        if (cores == max_cores) {
+            break;
+        }
+        cores = cores * 2 < max_cores ? cores * 2 : max_cores;
+    }
+
+    // only the status line dirty
+    auto presented = 0ull;
+    auto const t2 = kernel::core::read_tsc();
+    for (auto i = 0u; i < frames; ++i) {
+        back.dirty.mark(0, 0, fb.width, STATUS_HEIGHT);
+        presented += back.dirty.present(fb, front, max_cores);
+    }
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t2);
+
+    JsonLine{}
+        .p("bench", "present")
+        .p("dirty", "status_line")
+        .p("cores", max_cores)
+        .p("bytes_per_frame", presented / frames)
+        .p("ns_per_frame", ns / frames)
+        .end();
+}
+
+// characters of the status line drawn to the back buffer at scale 2 per
+// blitter, transparent and opaque, after the former rectangle per set pixel
+// path as the baseline
+auto bench_text(BackBuffer& back) -> void {
+    auto constexpr repeats = 1000u;
+    auto constexpr scale = 2u;
+    char constexpr line[]{"cores: 32   jobs: 32   fps: 60   scan"};
+    auto const chars = u64(sizeof(line) - 1) * repeats;
+    auto const& fb = back.fb;
+
+    // note: transparent only, the path had no background
+    auto const t_rects = kernel::core::read_tsc();
+    for (auto i = 0u; i < repeats; ++i) {
+        for (auto c = 0u; c < sizeof(line) - 1; ++c) {
+            auto* const dst = fb.pixels + 8 * fb.stride + 16 * (c + 1);
+            auto const* const bits = ASCII_FONT[font::printable(line[c])];
+            for (auto y = 0u; y < font::SIZE; ++y) {
+                for (auto x = 0u; x < font::SIZE; ++x) {
+                    if (!(bits[y] & (1 << (7 - x)))) {
+                        continue;
+                    }
+                    // one `scale` square per set pixel
+                    auto* const rect =
+                        dst + u64(y * scale) * fb.stride + x * scale;
+                    for (auto ry = 0u; ry < scale; ++ry) {
+                        for (auto rx = 0u; rx < scale; ++rx) {
+                            rect[u64(ry) * fb.stride + rx] = 0x00'ff'ff'00;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    auto const rects_ns =
+        kernel::core::tsc_to_ns(kernel::core::read_tsc() - t_rects);
+
+    JsonLine{}
+        .p("bench", "text")
+        .p("blitter", "rects")
+        .p("background", "transparent")
+        .p("chars", chars)
+        .p("ns_per_char", rects_ns / chars)
+        .p("chars_per_sec", chars * 1'000'000'000 / rects_ns)
+        .end();
+
+    struct Blitter {
+        char const* name;
+        bool avx2;
+    };
+    Blitter const blitters[]{{"scalar", false}, {"avx2", true}};
+
+    for (auto const& blitter : blitters) {
+        if (blitter.avx2 && !kernel::fpu.avx2) {
+            break;
+        }
+        for (auto opaque = 0u; opaque < 2; ++opaque) {
+            auto const t0 = kernel::core::read_tsc();
+            for (auto i = 0u; i < repeats; ++i) {
+                for (auto c = 0u; c < sizeof(line) - 1; ++c) {
+                    font::glyph(blitter.avx2,
+                                fb.pixels + 8 * fb.stride + 16 * (c + 1),
+                                fb.stride, line[c], scale, 0x00'ff'ff'00, 0,
+                                opaque != 0);
+                }
+            }
+            auto const ns =
+                kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+            JsonLine{}
+                .p("bench", "text")
+                .p("blitter", blitter.name)
+                .p("background", opaque ? "opaque" : "transparent")
+                .p("chars", chars)
+                .p("ns_per_char", ns / chars)
+                .p("chars_per_sec", chars * 1'000'000'000 / ns)
+                .end();
+        }
+    }
+}
+
+// lines logged by jobs on all cores, then drained into `text_console` and
+// drawn to the back buffer, scrolling every line once the console is full
+auto bench_console(BackBuffer& back) -> void {
+    auto constexpr repeats = 100u;
+    auto constexpr job_count = 32u;
+    // one lap of `console::log` per repeat
+    auto constexpr lines_per_job = 8u;
+
+    struct LogJob {
+        u32 job;
+        auto run() -> void {
+            for (auto i = 0u; i < lines_per_job; ++i) {
+                console::Line{}.p("job ").p(job).p(" line ").p(i).end();
+            }
+        }
+    };
+
+    text_console.invalidate();
+    auto const mark = [&back](u32 const x0, u32 const y0, u32 const x1,
+                              u32 const y1) {
+        back.dirty.mark(x0, y0, x1, y1);
+    };
+
+    auto lines = 0ull;
+    auto cells = 0ull;
+    auto const dropped = console::log.dropped();
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < repeats; ++i) {
+        for (auto j = 0u; j < job_count; ++j) {
+            osca::jobs.add<LogJob>(j);
+        }
+        osca::jobs.wait_idle();
+        lines += text_console.drain(console::log);
+        cells += text_console.draw(back.fb, mark);
+    }
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    JsonLine{}
+        .p("bench", "console")
+        .p("jobs", job_count)
+        .p("lines", lines)
+        .p("dropped", console::log.dropped() - dropped)
+        .p("cells_per_draw", cells / repeats)
+        .p("ns_per_line", ns / lines)
+        .end();
+}
+
+// frames per second of the zooming fractal presented every frame: rendered
+// then presented in one back buffer, and pipelined through
+// `config::FRAME_BUFFERS` back buffers so the next frames render while one is
+// presented
+auto bench_pipeline(BackBuffer* const buffers) -> void {
+    auto const frames = config::BENCHMARK_FRACTAL_ZOOM_FRAMES;
+    auto const& front = kernel::frame_buffer;
+
+    auto& serial = buffers[0];
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < frames; ++i) {
+        render_frame(serial, 32, i);
+        serial.dirty.present(serial.fb, front, kernel::core_count);
+    }
+    auto const serial_ns =
+        kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    auto const t1 = kernel::core::read_tsc();
+    auto dispatched = 0u;
+    for (auto i = 0u; i < frames; ++i) {
+        while (dispatched < frames && dispatched < i + config::FRAME_BUFFERS) {
+            dispatch_frame(buffers[dispatched % config::FRAME_BUFFERS], 32,
+                           dispatched);
+            ++dispatched;
+        }
+        auto& back = buffers[i % config::FRAME_BUFFERS];
+        back.wait();
+        back.dirty.present(back.fb, front, kernel::core_count);
+    }
+    auto const pipelined_ns =
+        kernel::core::tsc_to_ns(kernel::core::read_tsc() - t1);
+
+    JsonLine{}
+        .p("bench", "frame_loop")
+        .p("buffers", 1)
+        .p("frames", frames)
+        .p("ns_per_frame", serial_ns / frames)
+        .p("fps", u64(frames) * 1'000'000'000 / serial_ns)
+        .end();
+    JsonLine{}
+        .p("bench", "frame_loop")
+        .p("buffers", config::FRAME_BUFFERS)
+        .p("frames", frames)
+        .p("ns_per_frame", pipelined_ns / frames)
+        .p("fps", u64(frames) * 1'000'000'000 / pipelined_ns)
+        .end();
+}
+
+// single core `memcpy` (rep movsb) bandwidth
+auto bench_memcpy() -> void {
+    auto const bytes = config::BENCHMARK_MEMCPY_BYTES;
+    auto const repeats = config::BENCHMARK_MEMCPY_REPEATS;
+    auto const pages = (bytes + 4095) / 4096;
+
+    auto* const src = kernel::allocate_pages(pages);
+    auto* const dst = kernel::allocate_pages_uninit(pages);
+
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < repeats; ++i) {
+        memcpy(dst, src, bytes);
+    }
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    JsonLine{}
+        .p("bench", "memcpy")
+        .p("mode", "rep_movsb")
+        .p("bytes", u64(bytes) * repeats)
+        .p("ns", ns)
+        .p("mb_per_sec", u64(bytes) * repeats * 1'000 / ns)
+        .end();
+
+    kernel::free_pages(src, pages);
+    kernel::free_pages(dst, pages);
+}
+
+// single core `rep stosb` and `rep movsb` against `parallel_memset` and
+// `parallel_memcpy` on all cores
+auto bench_parallel_memory() -> void {
+    auto const bytes = config::BENCHMARK_MEMCPY_BYTES;
+    auto const repeats = config::BENCHMARK_MEMCPY_REPEATS;
+    auto const pages = (bytes + 4095) / 4096;
+
+    auto* const src = kernel::allocate_pages_uninit(pages);
+    auto* const dst = kernel::allocate_pages_uninit(pages);
+
+    auto const report = [&](char const* bench, char const* mode, u64 ns) {
+        JsonLine{}
+            .p("bench", bench)
+            .p("mode", mode)
+            .p("cores", kernel::core_count)
+            .p("bytes", u64(bytes) * repeats)
+            .p("ns", ns)
+            .p("mb_per_sec", u64(bytes) * repeats * 1'000 / ns)
+            .end();
+    };
+
+    auto t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < repeats; ++i) {
+        memset(src, i32(i), bytes);
+    }
+    report("memset", "rep_stosb",
+           kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0));
+
+    t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < repeats; ++i) {
+        osca::parallel_memset(src, i32(i), bytes);
+    }
+    report("memset", "parallel_nt",
+           kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0));
+
+    t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < repeats; ++i) {
+        osca::parallel_memcpy(dst, src, bytes);
+    }
+    report("memcpy", "parallel_nt",
+           kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0));
+
+    kernel::free_pages(src, pages);
+    kernel::free_pages(dst, pages);
+}
+
+// single page allocate and free from jobs on all cores
+// note: batches larger than a magazine exercise refill and drain
+auto bench_alloc() -> void {
+    struct AllocJob {
+        auto run() -> void {
+            void* pages[256];
+            for (auto i = 0u; i < config::BENCHMARK_ALLOC_ROUNDS; ++i) {
+                for (auto& p : pages) {
+                    p = kernel::memory::pages.allocate(1, false).address;
+                }
+                for (auto* const p : pages) {
+                    kernel::memory::pages.free(p, 1);
+                }
+            }
+        }
+    };
+
+    auto const job_count = kernel::core_count - 1u;
+
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < job_count; ++i) {
+        osca::jobs.add<AllocJob>();
+    }
+    osca::jobs.wait_idle();
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    auto const ops = u64(job_count) * config::BENCHMARK_ALLOC_ROUNDS * 256 * 2;
+    JsonLine{}
+        .p("bench", "alloc")
+        .p("jobs", job_count)
+        .p("ops", ops)
+        .p("ns", ns)
+        .p("ops_per_sec", ops * 1'000'000'000 / ns)
+        .end();
+}
+
+// `kmalloc` and `kfree` of mixed sizes from jobs on all cores followed by
+// objects allocated on the bsp and freed on other cores
+auto bench_kmalloc() -> void {
+    struct KmallocJob {
+        auto run() -> void {
+            void* objects[256];
+            for (auto i = 0u; i < config::BENCHMARK_ALLOC_ROUNDS; ++i) {
+                for (auto j = 0u; j < 256; ++j) {
+                    // sizes 8 to 2048 bytes
+                    objects[j] = kernel::kmalloc(8u << (j % 9));
+                }
+                for (auto* const p : objects) {
+                    kernel::kfree(p);
+                }
+            }
+        }
+    };
+
+    struct RemoteFreeJob {
+        void** objects;
+        u32 count;
+        auto run() -> void {
+            for (auto i = 0u; i < count; ++i) {
+                kernel::kfree(objects[i]);
+            }
+        }
+    };
+
+    auto const job_count = kernel::core_count - 1u;
+
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < job_count; ++i) {
+        osca::jobs.add<KmallocJob>();
+    }
+    osca::jobs.wait_idle();
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    auto const ops = u64(job_count) * config::BENCHMARK_ALLOC_ROUNDS * 256 * 2;
+    JsonLine{}
+        .p("bench", "kmalloc")
+        .p("jobs", job_count)
+        .p("ops", ops)
+        .p("ns", ns)
+        .p("ops_per_sec", ops * 1'000'000'000 / ns)
+        .end();
+
+    // remote frees
+    auto constexpr static COUNT = 1024u;
+    auto** const objects = ptr<void*>(kernel::kmalloc(COUNT * sizeof(void*)));
+    for (auto i = 0u; i < COUNT; ++i) {
+        objects[i] = kernel::kmalloc(64);
+    }
+    auto const per_job = COUNT / job_count;
+    for (auto i = 0u; i < job_count; ++i) {
+        auto const n = i == job_count - 1 ? COUNT - i * per_job : per_job;
+        osca::jobs.add<RemoteFreeJob>(objects + i * per_job, n);
+    }
+    osca::jobs.wait_idle();
+    kernel::kfree(objects);
+
+    auto const st = kernel::memory::slabs.stats();
+    JsonLine{}
+        .p("bench", "kmalloc_stats")
+        .p("allocs", st.allocs)
+        .p("frees", st.frees)
+        .p("remote_frees", st.remote_frees)
+        .p("slabs", st.slabs)
+        .p("large_allocs", st.large_allocs)
+        .p("large_frees", st.large_frees)
+        .end();
+}
+
+// scoped `frame_arenas` allocations of mixed sizes from jobs on all cores
+// note: same pattern as the `kmalloc` benchmark without the frees
+auto bench_arena() -> void {
+    struct ArenaJob {
+        auto run() -> void {
+            for (auto i = 0u; i < config::BENCHMARK_ALLOC_ROUNDS; ++i) {
+                auto scope =
+                    kernel::memory::ScopedArena{osca::frame_arenas[0]};
+                for (auto j = 0u; j < 256; ++j) {
+                    // sizes 8 to 2048 bytes
+                    auto* const p = scope.allocate(8u << (j % 9));
+                    if (!p) {
+                        kernel::serial::print("error: frame arena full\n");
+                        kernel::panic(0x00'ff'00'00); // red
+                    }
+                }
+            }
+        }
+    };
+
+    auto const job_count = kernel::core_count - 1u;
+
+    osca::frame_arenas[0].reset();
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < job_count; ++i) {
+        osca::jobs.add<ArenaJob>();
+    }
+    osca::jobs.wait_idle();
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    auto const ops = u64(job_count) * config::BENCHMARK_ALLOC_ROUNDS * 256;
+    JsonLine{}
+        .p("bench", "arena")
+        .p("jobs", job_count)
+        .p("ops", ops)
+        .p("ns", ns)
+        .p("ops_per_sec", ops * 1'000'000'000 / ns)
+        .p("peak_bytes", osca::frame_arenas[0].peak_bytes())
+        .end();
+}
+
+// zeroed allocation with the pool idle cores filled during earlier benchmarks
+// and bytes zeroed on and off the allocation path so far
+auto bench_zeroing() -> void {
+    auto const pages = config::BENCHMARK_MEMCPY_BYTES / 4096;
+
+    auto const t0 = kernel::core::read_tsc();
+    auto* const p = kernel::allocate_pages(pages);
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+    kernel::free_pages(p, pages);
+
+    auto const stats = kernel::memory::pages.zero_stats();
+    JsonLine{}
+        .p("bench", "zeroing")
+        .p("bytes", u64(pages) * 4096)
+        .p("alloc_ns", ns)
+        .p("idle_bytes", stats.idle_bytes)
+        .p("prezeroed_bytes", stats.prezeroed_bytes)
+        .p("sync_bytes", stats.sync_bytes)
+        .p("clean_bytes", kernel::memory::clean_bytes())
+        .end();
+}
+
+// random reads one per page across a large buffer; dominated by tlb misses
+// with small pages
+// note: compare runs with `config::USE_1G_PAGES` true and false; the buffer
+//       is the largest power of 2 up to `config::BENCHMARK_TLB_BYTES` that
+//       is free in one block
+auto bench_tlb() -> void {
+    auto const reads = config::BENCHMARK_TLB_READS;
+
+    // note: not `allocate_pages_uninit`, which panics when out of memory
+    auto bytes = config::BENCHMARK_TLB_BYTES;
+    auto* buffer = static_cast<u8*>(nullptr);
+    while (true) {
+        buffer = ptr<u8>(
+            kernel::memory::pages.allocate(bytes / 4096, false).address);
+        if (buffer || bytes / 2 < config::BENCHMARK_TLB_MIN_BYTES) {
+            break;
+        }
+        bytes /= 2;
+    }
+    if (!buffer) {
+        JsonLine{}
+            .p("bench", "tlb")
+            .p("skipped", "no free block")
+            .p("min_bytes", config::BENCHMARK_TLB_MIN_BYTES)
+            .end();
+        return;
+    }
+    auto const pages = bytes / 4096;
+
+    // xorshift page index; sum keeps the reads
+    auto x = 0x9e37'79b9'7f4a'7c15ull;
+    auto sum = 0ull;
+    auto const t0 = kernel::core::read_tsc();
+    for (auto i = 0u; i < reads; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        sum += buffer[(x % pages) * 4096];
+    }
+    auto const ns = kernel::core::tsc_to_ns(kernel::core::read_tsc() - t0);
+
+    JsonLine{}
+        .p("bench", "tlb")
+        .p("bytes", bytes)
+        .p("reads", reads)
+        .p("ns", ns)
+        .p("ps_per_read", ns * 1'000 / reads)
+        .p("pages_1g", kernel::paging.pages_1g)
+        .p("pages_2m", kernel::paging.pages_2m)
+        .p("pages_4k", kernel::paging.pages_4k)
+        .p("table_bytes", kernel::paging.table_pages * 4096)
+        .p("sum", sum)
+        .end();
+
+    kernel::free_pages(buffer, pages);
+}
+
+// round trip from sending an ipi until the target core acknowledged it
+auto bench_ipi() -> void {
+    auto const round_trips = config::BENCHMARK_IPI_ROUND_TRIPS;
+    auto const self = kernel::core::apic_id();
+
+    for (auto i = 0u; i < kernel::core_count; ++i) {
+        auto const apic_id = kernel::cores[i].apic_id;
+        if (apic_id == self) {
+            continue;
+        }
+
+        auto const t0 = kernel::core::read_tsc();
+        for (auto j = 0u; j < round_trips; ++j) {
+            auto const acks = atomic::load(&ipi_acks, atomic::RELAXED);
+            kernel::send_ipi(apic_id);
+            while (atomic::load(&ipi_acks, atomic::RELAXED) == acks) {
+                kernel::core::pause();
+            }
+        }
+        auto const cycles = kernel::core::read_tsc() - t0;
+
+        JsonLine{}
+            .p("bench", "ipi")
+            .p("core", i)
+            .p("apic_id", apic_id)
+            .p("round_trips", round_trips)
+            .p("cycles", cycles / round_trips)
+            .p("ns", kernel::core::tsc_to_ns(cycles) / round_trips)
+            .end();
+    }
+}
+
+// cost of one self-interrupt round trip per entry tier; the difference is
+// the general purpose and extended state save/restore
+auto bench_interrupts() -> void {
+    auto const round_trips = config::BENCHMARK_IPI_ROUND_TRIPS;
+
+    struct Tier {
+        kernel::IsrTier tier;
+        char const* name;
+    };
+    Tier constexpr tiers[]{
+        {kernel::IsrTier::MINIMAL, "minimal"},
+        {kernel::IsrTier::FULL, "full"},
+    };
+
+    for (auto const& t : tiers) {
+        auto const t0 = kernel::core::read_tsc();
+        for (auto i = 0u; i < round_trips; ++i) {
+            kernel::interrupt_self(t.tier);
+        }
+        auto const cycles = kernel::core::read_tsc() - t0;
+
+        JsonLine{}
+            .p("bench", "interrupt")
+            .p("tier", t.name)
+            .p("xsave_bytes", kernel::fpu.save_bytes)
+            .p("round_trips", round_trips)
+            .p("cycles", cycles / round_trips)
+            .p("ns", kernel::core::tsc_to_ns(cycles) / round_trips)
+            .end();
+    }
+}
+
+// boot phase durations and application processor bring-up from the boot
+// timeline
+auto bench_boot() -> void {
+    auto const& tl = kernel::boot::timeline;
+    for (auto i = 0u; i + 1 < tl.phase_count; ++i) {
+        auto const ticks = tl.phases[i + 1].tsc - tl.phases[i].tsc;
+        JsonLine{}
+            .p("bench", "boot")
+            .p("phase", tl.phases[i].name)
+            .p("us", kernel::core::tsc_to_ns(ticks) / 1'000)
+            .end();
+    }
+
+    if (tl.keyboard_ready_tsc) {
+        auto const ticks = tl.keyboard_ready_tsc - tl.phases[0].tsc;
+        JsonLine{}
+            .p("bench", "keyboard_ready")
+            .p("us_after_efi_main", kernel::core::tsc_to_ns(ticks) / 1'000)
+            .end();
+    }
+
+    for (auto i = 1u; i < kernel::core_count; ++i) {
+        JsonLine{}
+            .p("bench", "core_start")
+            .p("core", i)
+            .p("parallel", config::PARALLEL_CORE_START ? 1u : 0u)
+            .p("us", kernel::core::tsc_to_ns(tl.core_start_ticks[i]) / 1'000)
+            .end();
+    }
+}
+
+// runs the benchmark suite and exits qemu
+[[noreturn]] auto run_benchmarks() -> void {
+    JsonLine{}
+        .p("bench", "system")
+        .p("cores", kernel::core_count)
+        .p("numa_nodes", kernel::numa.node_count)
+        .p("tsc_hz", kernel::clock.tsc_ticks_per_sec)
+        .p("width", kernel::frame_buffer.width)
+        .p("height", kernel::frame_buffer.height)
+        .end();
+
+    BackBuffer buffers[config::FRAME_BUFFERS];
+    for (auto i = 0u; i < config::FRAME_BUFFERS; ++i) {
+        buffers[i].init(kernel::frame_buffer, osca::frame_arenas[i]);
+    }
+
+    bench_boot();
+    bench_queue();
+    bench_fractal(buffers[0]);
+    bench_present(buffers[0]);
+    bench_text(buffers[0]);
+    bench_console(buffers[0]);
+    bench_pipeline(buffers);
+    bench_memcpy();
+    bench_parallel_memory();
+    bench_alloc();
+    bench_kmalloc();
+    bench_arena();
+    bench_zeroing();
+    bench_tlb();
+    bench_interrupts();
+    bench_ipi();
+
+    JsonLine{}.p("bench", "done").end();
+
+    kernel::qemu::exit(0);
+}
+
+} // namespace
+
+namespace osca {
+
+class Printer {
+    kernel::FrameBuffer fb_;
+    u32 row_ = 0;
+    u32 col_ = 0;
+    u32 color_ = 0xff'ff'ff'ff;
+    u32 background_ = 0;
+    bool opaque_ = false;
+    u32 scale_ = 1;
+    u32 defcol_ = 0;
+
+    auto drwchr(char const c) -> void {
+        auto const size = font::SIZE * scale_;
+        auto* const dst =
+            fb_.pixels + u64(row_ * size) * fb_.stride + col_ * size;
+        font::glyph(kernel::fpu.avx2, dst, fb_.stride, c, scale_, color_,
+                    background_, opaque_);
     }
 
   public:
@@ -256,6 +2180,19 @@ class Printer {
 
     auto color() const -> u32 { return color_; }
 
+    // fills the cell behind each character with `color`
+    auto background(u32 const color) -> Printer& {
+        background_ = color;
+        opaque_ = true;
+        return *this;
+    }
+
+    // draws only the pixels of each character
+    auto transparent() -> Printer& {
+        opaque_ = false;
+        return *this;
+    }
+
     auto scale(u32 const s) -> Printer& {
         scale_ = s;
         return *this;
@@ -317,13 +2254,18 @@ class Printer {
     }
 };
 
-auto static tick = 0u;
 auto static space_pressed = 0u;
 
 [[noreturn]] auto start() -> void {
     kernel::serial::print("osca x64 kernel is running\n");
 
     jobs.init();
+    for (auto& q : node_jobs) {
+        q.init();
+    }
+    background_jobs.init();
+    priority_jobs.init();
+    console::log.init();
 
     auto di = kernel::frame_buffer.pixels;
     for (auto i = 0u;
@@ -360,7 +2302,7 @@ auto static space_pressed = 0u;
     pr.p("           hpet: ").p_hex(u64(kernel::hpet.address)).nl();
     pr.color(pr.color() == main_color ? alt_color : main_color);
 
-    pr.p("      heap size: ").p_hex(kernel::heap.size).nl();
+    pr.p("    free memory: ").p_hex(kernel::memory::free_bytes()).nl();
     pr.color(pr.color() == main_color ? alt_color : main_color);
 
     pr.p("   keyboard gsi: ").p(kernel::keyboard_config.gsi).nl();
@@ -377,152 +2319,243 @@ auto static space_pressed = 0u;
 
     test_simd_support();
 
+    fractal_simd = kernel::fpu.avx512 ? fractal::Simd::AVX512
+                   : kernel::fpu.avx2 ? fractal::Simd::AVX2
+                                      : fractal::Simd::SCALAR;
+    kernel::serial::print("fractal kernel: ");
+    kernel::serial::print(fractal::simd_name(fractal_simd));
+    kernel::serial::print("\n");
+    console::Line{}
+        .p("fractal kernel: ")
+        .p(fractal::simd_name(fractal_simd))
+        .end();
+
+    for (auto& arena : frame_arenas) {
+        arena.init(config::FRAME_ARENA_BYTES);
+    }
+    text_console.init(0, STATUS_HEIGHT, kernel::frame_buffer.width,
+                      kernel::frame_buffer.height - STATUS_HEIGHT, 2);
+
     kernel::core::interrupts_enable();
 
+    if constexpr (config::BENCHMARK) {
+        run_benchmarks();
+    }
+
     while (!space_pressed) {
         kernel::core::pause();
     }
 
-    auto const frame_buffer_pages_count =
-        (kernel::frame_buffer.height * kernel::frame_buffer.stride + 4095) /
-        4096;
-    u32* pixels = ptr<u32>(kernel::allocate_pages(frame_buffer_pages_count));
-
-    kernel::FrameBuffer fb = kernel::frame_buffer;
-    fb.pixels = pixels;
-
-    struct FractalJob {
-        kernel::FrameBuffer fb;
-        u32 y_start;
-        u32 y_end;
-        u32 frame; // use frame for zoom level
-
-        auto run() -> void {
-            auto const width = fb.width;
-            auto const height = fb.height;
-            auto const stride = fb.stride;
-            auto* pixels = fb.pixels;
-
-            // Target coordinates to zoom into
-            auto const target_re = -0.743643f;
-            auto const target_im = 0.131825f;
-
-            // Calculate zoom scale: shrinks as frame increases
-            auto zoom = 1.0f;
-            for (auto i = 0u; i < (frame % 500u); ++i) {
-                zoom *= 0.95f;
-            }
-
-            // Define the viewport based on the current zoom
-            auto const base_w = 3.5f;
-            auto const base_h = 2.0f;
-            auto const min_re = target_re - (base_w * zoom) / 2.0f;
-            auto const max_re = target_re + (base_w * zoom) / 2.0f;
-            auto const min_im = target_im - (base_h * zoom) / 2.0f;
-            auto const max_im = target_im + (base_h * zoom) / 2.0f;
-
-            auto const re_factor = (max_re - min_re) / float(width - 1u);
-            auto const im_factor = (max_im - min_im) / float(height - 1u);
-
-            for (auto y = y_start; y < y_end; ++y) {
-                auto c_im = max_im - float(y) * im_factor;
-                for (auto x = 0u; x < width; ++x) {
-                    auto c_re = min_re + float(x) * re_factor;
-
-                    auto z_re = c_re, z_im = c_im;
-                    auto iteration = 0u;
-                    // increase max iterations as you zoom for better detail
-                    auto const max_iterations = 128u;
-
-                    while ((z_re * z_re + z_im * z_im <= 4.0f) &&
-                           (iteration < max_iterations)) {
-                        auto next_re = z_re * z_re - z_im * z_im + c_re;
-                        auto next_im = 2.0f * z_re * z_im + c_im;
-                        z_re = next_re;
-                        z_im = next_im;
-                        ++iteration;
-                    }
-
-                    auto color = 0u;
-                    if (iteration < max_iterations) {
-                        // dynamic coloring: blue shifts based on zoom/frame
-                        auto blue = (iteration * 255u / max_iterations) & 0xffu;
-                        auto red = (frame / 2u) & 0xffu;
-                        color = (red << 16u) | (blue << 8u) | 255u;
-                    } else {
-                        color = 0x00000000;
-                    }
-
-                    pixels[y * stride + x] = color;
-                }
-            }
-        }
-    };
+    BackBuffer buffers[config::FRAME_BUFFERS];
+    for (auto i = 0u; i < config::FRAME_BUFFERS; ++i) {
+        buffers[i].init(kernel::frame_buffer, frame_arenas[i]);
+    }
 
     auto job_count = 1u;
-    auto fps_tick = tick;
+    auto fps_tick = atomic::load(&kernel::ticks, atomic::RELAXED);
+    auto heartbeat_tick = fps_tick;
     auto fps_frame = 0u;
     auto fps = 0u;
     auto fractal_zoom = 0u;
+    auto present_bytes = 0ull;
+    auto fps_present_bytes = 0ull;
+
+    // buffer presented next and frames dispatched to it and the following
+    // buffers
+    auto back = 0u;
+    auto in_flight = 0u;
+
+    // buffer holding the console as last drawn; null while hidden
+    BackBuffer const* console_target = nullptr;
+    auto previous_mode = FractalMode::SCAN;
+    auto previous_show_console = false;
+    // keyboard handshake result logged; the boot timeline has it if it ended
+    // before `start`
+    auto keyboard_logged = kernel::boot::timeline.keyboard_ready_tsc != 0 ||
+                           kernel::boot::timeline.keyboard_failed != 0;
+
+    console::Line{}.p("keys: m mode, z zoom, c console").end();
 
     kernel::core::interrupts_enable();
 
     while (true) {
-        auto dy = kernel::frame_buffer.height / job_count;
-        auto y = 0u;
-        for (auto i = 0u; i < job_count; ++i) {
-            // if height isn't perfectly divisible, the last core takes the
-            // remainder
-            auto y_end =
-                (i == job_count - 1) ? kernel::frame_buffer.height : y + dy;
-
-            jobs.add<FractalJob>(fb, y, y_end, fractal_zoom);
+        auto const mode = FractalMode(
+            atomic::load(&fractal_mode_toggles, atomic::RELAXED) %
+            FRACTAL_MODE_COUNT);
+        auto const show_console =
+            (atomic::load(&console_toggles, atomic::RELAXED) & 1u) != 0;
+        if (mode != previous_mode || show_console != previous_show_console) {
+            // progressive passes keep drawing into their buffer, which the
+            // console or another mode draws into next; they start over when
+            // shown again
+            fractal_progressive.cancel();
+        }
+        if (mode != previous_mode) {
+            console::Line{}.p("mode: ").p(fractal_mode_name(mode)).end();
+            previous_mode = mode;
+        }
+        previous_show_console = show_console;
+
+        // note: set by the keyboard and timer interrupts on this core
+        if (!keyboard_logged) {
+            auto const& tl = kernel::boot::timeline;
+            auto const ready =
+                atomic::load(&tl.keyboard_ready_tsc, atomic::RELAXED);
+            if (ready) {
+                console::Line{}
+                    .p("keyboard ready: ")
+                    .p(kernel::core::tsc_to_ns(ready - tl.phases[0].tsc) /
+                       1'000)
+                    .p(" us after efi_main, attempts: ")
+                    .p(tl.keyboard_attempts)
+                    .end();
+                keyboard_logged = true;
+            } else if (atomic::load(&tl.keyboard_failed, atomic::RELAXED)) {
+                console::Line{}
+                    .p("error: keyboard did not acknowledge enable")
+                    .end();
+                keyboard_logged = true;
+            }
+        }
+        // the console is drawn incrementally into one buffer
+        auto const pipelined = !show_console && is_pipelined(mode);
+        if (!show_console) {
+            console_target = nullptr;
+        }
 
-            y = y_end;
+        // cells change while hidden too so the log never fills up
+        text_console.drain(console::log);
+
+        // dispatch the next frames to the free buffers; frames in flight of
+        // a previous mode are presented first
+        while (pipelined ? in_flight < config::FRAME_BUFFERS
+                         : in_flight == 0) {
+            auto& target = buffers[(back + in_flight) % config::FRAME_BUFFERS];
+            if (show_console) {
+                if (console_target != &target) {
+                    // drawn over by the fractal; clear the status line band
+                    // and redraw every cell
+                    auto const& fb = target.fb;
+                    for (auto y = 0u; y < STATUS_HEIGHT; ++y) {
+                        auto* const row = fb.pixels + u64(y) * fb.stride;
+                        for (auto x = 0u; x < fb.width; ++x) {
+                            row[x] = console::BACKGROUND;
+                        }
+                    }
+                    text_console.invalidate();
+                    console_target = &target;
+                }
+                auto const mark = [&target](u32 const x0, u32 const y0,
+                                            u32 const x1, u32 const y1) {
+                    target.dirty.mark(x0, y0, x1, y1);
+                };
+                text_console.draw(target.fb, mark);
+            } else {
+                if (mode == FractalMode::PROGRESSIVE) {
+                    // present each pass; the next one starts once it was
+                    // presented and a view change cancels it
+                    fractal_progressive.show(target, job_count,
+                                             fractal_zoom);
+                    while (!fractal_progressive.pass_done()) {
+                        kernel::core::pause();
+                    }
+                } else {
+                    dispatch_frame(target, job_count, fractal_zoom, mode);
+                }
+                if (atomic::load(&fractal_zoom_toggles, atomic::RELAXED) &
+                    1u) {
+                    ++fractal_zoom;
+                }
+            }
+            ++in_flight;
         }
 
-        jobs.wait_idle();
+        // only the buffer presented now is waited for
+        auto& buffer = buffers[back];
+        buffer.wait();
+        // the next frame dispatched to this buffer starts on an empty arena
+        buffer.arena->reset();
+        auto const& fb = buffer.fb;
 
         auto p = Printer(fb);
         p.position(1, 1).scale(2);
+        if (show_console) {
+            // nothing redraws the band under changing digits
+            p.background(console::BACKGROUND);
+        }
         p.p("cores: ")
             .p(kernel::core_count)
             .p("   jobs: ")
             .p(job_count)
             .p("   fps: ")
-            .p(fps);
+            .p(fps)
+            .p("   ")
+            .p(show_console ? "console" : fractal_mode_name(mode))
+            .p("   present kb: ")
+            .p(present_bytes / 1024)
+            .p("   ");
+        // status line is text row 1 at scale 2
+        buffer.dirty.mark(0, 0, fb.width, STATUS_HEIGHT);
+
+        present_bytes =
+            buffer.dirty.present(fb, kernel::frame_buffer, kernel::core_count);
+        fps_present_bytes += present_bytes;
+
+        // refines the buffer in the background until the next frame
+        // note: started only now so the pass does not draw into the status
+        //       line and the buffer while they are presented
+        if (!show_console && mode == FractalMode::PROGRESSIVE) {
+            fractal_progressive.next_pass();
+        }
 
-        memcpy(kernel::frame_buffer.pixels, pixels,
-               kernel::frame_buffer.height * kernel::frame_buffer.stride *
-                   sizeof(u32));
+        // serial modes keep building on the same buffer
+        --in_flight;
+        if (pipelined || in_flight > 0) {
+            back = (back + 1) % config::FRAME_BUFFERS;
+        }
 
         ++fps_frame;
-        //++fractal_zoom;
+
+        // note: the timer interrupt only counts ticks; the heartbeat is
+        // drawn from here so the handler never touches the job queue
+        auto const tick = atomic::load(&kernel::ticks, atomic::RELAXED);
+        if (tick != heartbeat_tick) {
+            heartbeat_tick = tick;
+
+            struct Job {
+                u64 t;
+                auto run() -> void {
+                    draw_rect(0, 0, 32, 32, u32(t << 6));
+                }
+            };
+
+            jobs.try_add<Job>(tick);
+        }
 
         auto const dt = tick - fps_tick;
         auto constexpr static seconds_per_fps_calculation = 10;
         if (dt >= config::TIMER_FREQUENCY_HZ * seconds_per_fps_calculation) {
-            fps = fps_frame * config::TIMER_FREQUENCY_HZ / dt;
-            fps_frame = 0;
-            fps_tick = tick;
-            job_count = (job_count % 32) + 1;
+            fps = u32(fps_frame * config::TIMER_FREQUENCY_HZ / dt);
             kernel::serial::print("fps: ");
             kernel::serial::print_dec(fps);
+            kernel::serial::print(", present bytes per frame: ");
+            kernel::serial::print_dec(fps_present_bytes / fps_frame);
             kernel::serial::print("\n");
+            console::Line{}
+                .p("fps: ")
+                .p(fps)
+                .p(", present bytes per frame: ")
+                .p(fps_present_bytes / fps_frame)
+                .end();
+            fps_frame = 0;
+            fps_present_bytes = 0;
+            fps_tick = tick;
+            job_count = (job_count % 32) + 1;
         }
     }
 }
 
-auto on_timer() -> void {
-    ++tick;
-
-    struct Job {
-        u32 t;
-        auto run() -> void { draw_rect(0, 0, 32, 32, t << 6); }
-    };
-
-    jobs.try_add<Job>(tick);
-}
+auto on_ipi() -> void { atomic::add(&ipi_acks, 1u, atomic::RELAXED); }
 
 auto on_keyboard(u8 const scancode) -> void {
     auto static kbd_intr_total = 0ull;
@@ -533,16 +2566,32 @@ auto on_keyboard(u8 const scancode) -> void {
         u64 total;
         u8 scancode;
         auto run() -> void {
-            draw_rect(32, 0, 32, 32, u32(scancode) << 16);
-            draw_rect(0, 20 * 8 * 3, kernel::frame_buffer.width, 4 * 8 * 3, 0);
-            print_string(1, 20, 0x0000ff00, "kbd intr: ", 3);
-            print_hex(12, 20, 0x0000ff00, total, 3);
-            print_string(1, 21, 0x00ffffff, "scancode: ", 3);
-            print_hex(12, 21, 0x00ffffff, scancode, 3);
             if (scancode == 0xb9) {
                 // space released
                 space_pressed = 1u;
             }
+            if (scancode == 0x32) {
+                // 'm' pressed
+                atomic::add(&fractal_mode_toggles, 1u, atomic::RELAXED);
+            }
+            if (scancode == 0x2c) {
+                // 'z' pressed
+                atomic::add(&fractal_zoom_toggles, 1u, atomic::RELAXED);
+            }
+            if (scancode == 0x2e) {
+                // 'c' pressed
+                atomic::add(&console_toggles, 1u, atomic::RELAXED);
+            }
+            if (scancode < 0x80) {
+                // note: the front buffer is not drawn to; it may show the
+                //       console
+                console::Line{}
+                    .p("key: ")
+                    .p_hex(scancode, 2)
+                    .p("   kbd intr: ")
+                    .p(total)
+                    .end();
+            }
         }
     };
 
@@ -551,8 +2600,8 @@ auto on_keyboard(u8 const scancode) -> void {
 
 [[noreturn]] auto run_core([[maybe_unused]] u32 core_id) -> void {
     while (true) {
-        if (!jobs.run_next()) {
-            // queue empty, pause
+        if (!run_next_job() && !kernel::zero_free_pages()) {
+            // queue empty and nothing to zero, pause
             kernel::core::pause();
         }
     }
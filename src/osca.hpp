@@ -1,7 +1,9 @@
 #pragma once
 
 #include "atomic.hpp"
+#include "config.hpp"
 #include "kernel.hpp"
+#include "memory.hpp"
 #include "types.hpp"
 
 namespace osca {
@@ -417,4 +419,136 @@ template <u32 QueueSize = 256> class Mpmc final {
 
 queue::Mpmc<256> inline jobs;
 
+// jobs preferably run by cores of a numa node, e.g. touching its memory
+// note: cores of other nodes take them when idle
+queue::Mpmc<256> inline node_jobs[kernel::MAX_NUMA_NODES];
+
+// low priority jobs run only when every other queue is empty
+// note: e.g. refinement that a newer request makes obsolete; such jobs check
+//       a generation and return early when cancelled
+queue::Mpmc<256> inline background_jobs;
+
+// high priority jobs run before every other queue
+// note: e.g. presenting a frame while the next one renders
+queue::Mpmc<256> inline priority_jobs;
+
+// runs a job from the priority queue, then the calling core's node queue,
+// then the shared queue, then the other nodes' queues nearest first, then the
+// background queue
+// returns false if no job was run
+auto inline run_next_job() -> bool {
+    if (priority_jobs.run_next()) {
+        return true;
+    }
+    auto const node = kernel::core::node();
+    if (node_jobs[node].run_next() || jobs.run_next()) {
+        return true;
+    }
+    auto const* const order = kernel::numa.order[node];
+    for (auto i = 1u; i < kernel::numa.node_count; ++i) {
+        if (node_jobs[order[i]].run_next()) {
+            return true;
+        }
+    }
+    return background_jobs.run_next();
+}
+
+// temporary memory for jobs, one per back buffer; a frame's jobs use the
+// arena of the buffer they render to, reset once that frame was waited for
+kernel::memory::FrameArena inline frame_arenas[config::FRAME_BUFFERS];
+
+// bytes per job in `parallel_memset` and `parallel_memcpy`
+auto constexpr PARALLEL_CHUNK_BYTES = 2 * 1024 * 1024ull;
+
+namespace detail {
+
+struct MemsetJob {
+    u8* dest;
+    u64 bytes;
+    u32* remaining;
+    i32 value;
+
+    auto run() -> void {
+        kernel::memset_nt(dest, value, bytes);
+        // (1) paired with acquire (2)
+        atomic::sub(remaining, 1u, atomic::RELEASE);
+    }
+};
+
+struct MemcpyJob {
+    u8* dest;
+    u8 const* src;
+    u64 bytes;
+    u32* remaining;
+
+    auto run() -> void {
+        kernel::memcpy_nt(dest, src, bytes);
+        // (1) paired with acquire (2)
+        atomic::sub(remaining, 1u, atomic::RELEASE);
+    }
+};
+
+// splits `[dest, dest + n)` at 2MB boundaries and adds a job per chunk with
+// `try_add(queue, offset, bytes, remaining)` to the queue of the chunk's numa
+// node; runs jobs while the queue is full and until all chunks are done
+template <typename F>
+auto run_chunked(void* const dest, u64 const n, F try_add) -> void {
+    auto remaining = 0u;
+    auto offset = 0ull;
+    while (offset < n) {
+        auto const address = uptr(dest) + offset;
+        auto const boundary =
+            (address + PARALLEL_CHUNK_BYTES) & ~(PARALLEL_CHUNK_BYTES - 1);
+        auto const bytes =
+            boundary - address < n - offset ? boundary - address : n - offset;
+        auto& queue = kernel::numa.node_count > 1
+                          ? node_jobs[kernel::node_of(address)]
+                          : jobs;
+        atomic::add(&remaining, 1u, atomic::RELAXED);
+        while (!try_add(queue, offset, bytes, &remaining)) {
+            if (!run_next_job()) {
+                kernel::core::pause();
+            }
+        }
+        offset += bytes;
+    }
+
+    // help while waiting
+    // (2) paired with release (1)
+    while (atomic::load(&remaining, atomic::ACQUIRE) != 0) {
+        if (!run_next_job()) {
+            kernel::core::pause();
+        }
+    }
+}
+
+} // namespace detail
+
+// memset of large buffers with non-temporal stores in 2MB chunks run as jobs
+// on all cores, preferably on the chunk's numa node; the calling core runs
+// jobs while waiting
+auto inline parallel_memset(void* const dest, i32 const c, u64 const n)
+    -> void {
+    detail::run_chunked(dest, n,
+                        [&](queue::Mpmc<256>& q, u64 const offset,
+                            u64 const bytes, u32* const r) {
+                            return q.try_add<detail::MemsetJob>(
+                                ptr<u8>(dest) + offset, bytes, r, c);
+                        });
+}
+
+// memcpy of large non-overlapping buffers with non-temporal stores in 2MB
+// chunks run as jobs on all cores, preferably on the destination chunk's numa
+// node; the calling core runs jobs while waiting
+auto inline parallel_memcpy(void* const dest, void const* const src,
+                            u64 const n) -> void {
+    detail::run_chunked(dest, n,
+                        [&](queue::Mpmc<256>& q, u64 const offset,
+                            u64 const bytes, u32* const r) {
+                            return q.try_add<detail::MemcpyJob>(
+                                ptr<u8>(dest) + offset,
+                                ptr<u8 const>(src) + offset, bytes, r);
+                        });
+}
+
 } // namespace osca
@@ -46,6 +46,8 @@ extern "C" auto EFIAPI efi_main(EFI_HANDLE const img,
                                 EFI_SYSTEM_TABLE const* const sys)
     -> EFI_STATUS {
 
+    kernel::boot::mark("efi_main");
+
     sys->ConOut->ClearScreen(sys->ConOut);
 
     console_print(sys, u"efi_main\r\n");
@@ -56,6 +58,8 @@ extern "C" auto EFIAPI efi_main(EFI_HANDLE const img,
     // get frame buffer config
     //
 
+    kernel::boot::mark("locate_gop");
+
     // locate the gop (graphics output protocol) to get a linear frame buffer
     EFI_GUID graphics_guid = EFI_GRAPHICS_OUTPUT_PROTOCOL_GUID;
     EFI_GRAPHICS_OUTPUT_PROTOCOL* gop = nullptr;
@@ -75,6 +79,8 @@ extern "C" auto EFIAPI efi_main(EFI_HANDLE const img,
     // get keyboard config, io_apic and lapic pointers
     //
 
+    kernel::boot::mark("parse_acpi");
+
     // get root system description pointer (rsdp)
     //  the "entry point" found via uefi
     struct [[gnu::packed]] RSDP {
@@ -140,6 +146,30 @@ extern "C" auto EFIAPI efi_main(EFI_HANDLE const img,
     MADT_IOAPIC io_apics[MAX_IO_APICS];
     auto io_apic_count = 0u;
 
+    // numa proximity domains in order found; index is the node
+    u32 numa_domains[kernel::MAX_NUMA_NODES];
+    kernel::numa.node_count = 0;
+
+    // node of proximity `domain`; adds new domains
+    // returns `MAX_NUMA_NODES` if there are more domains than configured
+    auto const node_of_domain = [&](u32 const domain) -> u32 {
+        for (auto n = 0u; n < kernel::numa.node_count; ++n) {
+            if (numa_domains[n] == domain) {
+                return n;
+            }
+        }
+        if (kernel::numa.node_count == kernel::MAX_NUMA_NODES) {
+            return kernel::MAX_NUMA_NODES;
+        }
+        auto const node = kernel::numa.node_count;
+        numa_domains[node] = domain;
+        ++kernel::numa.node_count;
+        return node;
+    };
+
+    // system locality information table; parsed after all domains are known
+    SDTHeader const* slit = nullptr;
+
     // find apic values and keyboard configuration
     // parse the madt (multiple apic description table) to route interrupts
     for (auto i = 0u; i < entries; ++i) {
@@ -182,8 +212,10 @@ extern "C" auto EFIAPI efi_main(EFI_HANDLE const img,
                     };
                     auto const* const core = ptr<MADT_LAPIC>(curr);
                     if (core->flags & 3) { // if enabled or online capable
-                        kernel::cores[kernel::core_count] = {.apic_id =
-                                                                 core->apic_id};
+                        kernel::cores[kernel::core_count] = {
+                            .apic_id = core->apic_id,
+                            .index = kernel::core_count,
+                            .node = 0};
                         ++kernel::core_count;
                     }
                     break;
@@ -283,6 +315,181 @@ extern "C" auto EFIAPI efi_main(EFI_HANDLE const img,
                 return EFI_ABORTED;
             }
             kernel::hpet.address = ptr<u64>(hpet->base_address.address);
+            continue;
+        }
+
+        auto constexpr static SRAT_SIGNATURE =
+            u32(0x54415253); // 'SRAT' little-endian
+        if (*ptr<u32 const>(header->signature) == SRAT_SIGNATURE) {
+            console_print(sys, u"SRAT found\r\n");
+            // system resource affinity table
+            //  assigns cores and memory ranges to proximity domains
+            struct [[gnu::packed]] SRAT {
+                SDTHeader header;
+                u32 reserved1; // 1
+                u64 reserved2;
+                u8 entries[];
+            };
+            auto const* const srat = ptr<SRAT>(header);
+
+            auto const* curr = srat->entries;
+            auto const* const end = ptr_offset<void>(srat, srat->header.length);
+            while (curr < end) {
+                struct [[gnu::packed]] SRAT_EntryHeader {
+                    u8 type;
+                    u8 length;
+                };
+                auto const* const entry = ptr<SRAT_EntryHeader>(curr);
+
+                auto node = 0u;
+                switch (entry->type) {
+
+                // processor local apic affinity
+                case 0: {
+                    struct [[gnu::packed]] SRAT_LAPIC {
+                        u8 type;   // 0
+                        u8 length; // 16
+                        u8 domain_low;
+                        u8 apic_id;
+                        u32 flags; // bit 0: enabled
+                        u8 sapic_eid;
+                        u8 domain_high[3];
+                        u32 clock_domain;
+                    };
+                    auto const* const lapic = ptr<SRAT_LAPIC>(curr);
+                    if (!(lapic->flags & 1)) {
+                        break;
+                    }
+                    node = node_of_domain(
+                        u32(lapic->domain_low) |
+                        u32(lapic->domain_high[0]) << 8 |
+                        u32(lapic->domain_high[1]) << 16 |
+                        u32(lapic->domain_high[2]) << 24);
+                    kernel::numa.apic_node[lapic->apic_id] = u8(node);
+                    break;
+                }
+
+                // memory affinity
+                case 1: {
+                    struct [[gnu::packed]] SRAT_Memory {
+                        u8 type;   // 1
+                        u8 length; // 40
+                        u32 domain;
+                        u16 reserved1;
+                        u64 base;
+                        u64 size;
+                        u32 reserved2;
+                        u32 flags; // bit 0: enabled, bit 1: hot pluggable
+                        u64 reserved3;
+                    };
+                    auto const* const memory = ptr<SRAT_Memory>(curr);
+                    if (!(memory->flags & 1) || memory->size == 0) {
+                        break;
+                    }
+                    node = node_of_domain(memory->domain);
+                    if (kernel::numa.range_count >= kernel::MAX_NUMA_RANGES) {
+                        console_print(
+                            sys, u"abort: more NUMA ranges than configured");
+                        return EFI_ABORTED;
+                    }
+                    kernel::numa.ranges[kernel::numa.range_count] = {
+                        .start = memory->base,
+                        .end = memory->base + memory->size,
+                        .node = node};
+                    ++kernel::numa.range_count;
+                    break;
+                }
+
+                // processor local x2apic affinity
+                case 2: {
+                    struct [[gnu::packed]] SRAT_X2APIC {
+                        u8 type;   // 2
+                        u8 length; // 24
+                        u16 reserved1;
+                        u32 domain;
+                        u32 x2apic_id;
+                        u32 flags; // bit 0: enabled
+                        u32 clock_domain;
+                        u32 reserved2;
+                    };
+                    auto const* const x2apic = ptr<SRAT_X2APIC>(curr);
+                    // note: xapic mode addresses ids below 256 only
+                    if (!(x2apic->flags & 1) ||
+                        x2apic->x2apic_id >= MAX_CORES) {
+                        break;
+                    }
+                    node = node_of_domain(x2apic->domain);
+                    kernel::numa.apic_node[x2apic->x2apic_id] = u8(node);
+                    break;
+                }
+                }
+
+                if (node == kernel::MAX_NUMA_NODES) {
+                    console_print(sys,
+                                  u"abort: more NUMA nodes than configured");
+                    return EFI_ABORTED;
+                }
+
+                curr += entry->length;
+            }
+            continue;
+        }
+
+        auto constexpr static SLIT_SIGNATURE =
+            u32(0x54494c53); // 'SLIT' little-endian
+        if (*ptr<u32 const>(header->signature) == SLIT_SIGNATURE) {
+            console_print(sys, u"SLIT found\r\n");
+            slit = header;
+        }
+    }
+
+    //
+    // numa distances and fallback order
+    //
+
+    // default: single node or no slit; 10 local, 20 remote
+    if (kernel::numa.node_count == 0) {
+        kernel::numa.node_count = 1;
+        numa_domains[0] = 0;
+    }
+    for (auto i = 0u; i < kernel::numa.node_count; ++i) {
+        for (auto j = 0u; j < kernel::numa.node_count; ++j) {
+            kernel::numa.distance[i][j] = i == j ? 10 : 20;
+        }
+    }
+
+    if (slit) {
+        // system locality information table
+        //  relative distances between proximity domains as a matrix
+        struct [[gnu::packed]] SLIT {
+            SDTHeader header;
+            u64 locality_count;
+            u8 entries[]; // locality_count * locality_count
+        };
+        auto const* const table = ptr<SLIT const>(slit);
+        auto const count = table->locality_count;
+        for (auto i = 0u; i < kernel::numa.node_count; ++i) {
+            for (auto j = 0u; j < kernel::numa.node_count; ++j) {
+                if (numa_domains[i] < count && numa_domains[j] < count) {
+                    kernel::numa.distance[i][j] =
+                        table->entries[numa_domains[i] * count +
+                                       numa_domains[j]];
+                }
+            }
+        }
+    }
+
+    // nodes sorted by distance from each node; insertion sort
+    for (auto i = 0u; i < kernel::numa.node_count; ++i) {
+        auto* const order = kernel::numa.order[i];
+        auto const* const distance = kernel::numa.distance[i];
+        for (auto j = 0u; j < kernel::numa.node_count; ++j) {
+            auto k = j;
+            while (k > 0 && distance[order[k - 1]] > distance[j]) {
+                order[k] = order[k - 1];
+                --k;
+            }
+            order[k] = u8(j);
         }
     }
 
@@ -307,6 +514,8 @@ extern "C" auto EFIAPI efi_main(EFI_HANDLE const img,
     // get memory map, exit boot services and start kernel
     //
 
+    kernel::boot::mark("get_memory_map");
+
     UINTN size = 0;
     UINTN key = 0;
     UINTN descriptor_size = 0;
@@ -327,6 +536,8 @@ extern "C" auto EFIAPI efi_main(EFI_HANDLE const img,
         return EFI_ABORTED;
     }
 
+    kernel::boot::mark("exit_boot_services");
+
     // multiple attempts because interrupts etc may change the memory map
     // between GetMemoryMap and ExitBootServices
     for (auto i = 0u; i < 16; ++i) {